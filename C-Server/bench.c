@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include "frame_ring.h"
+#include "safety.h"
+#include "serial.h"
+#include "command.h"
+
+// 解析/编码/回复的微基准测试：使用模拟串口，不需要网络和STM32
+// 用法: relay_bench [-n 轮数] [-c 限位配置文件]
+
+#define STREAM_SIZE 65536
+
+static frame_ring_t frame_ring;
+static safety_table_t safety_table;
+static client_conn_t conn;
+static reply_buffer_t reply;
+static serial_pump_t pump;
+static unsigned char stream[STREAM_SIZE];
+static unsigned char serial_sink[SERIAL_BATCH_SIZE];
+
+// 生成混合指令流：以0xAA帧为主，夹杂0xBB宏动作和TEST，模拟滑块连续拖动
+size_t build_stream(unsigned char *out, size_t size, unsigned long *commands) {
+    size_t len = 0;
+    unsigned long count = 0;
+    for (unsigned i = 0; len + 4 <= size; i++) {
+        if (i % 64 == 63) {
+            memcpy(out + len, "TEST", 4);
+            len += 4;
+        } else if (i % 32 == 31) {
+            out[len++] = 0xBB;
+            out[len++] = 0x04;                  // 放：单步宏动作
+        } else {
+            out[len++] = 0xAA;
+            out[len++] = (unsigned char)(i % 6);
+            out[len++] = (unsigned char)(60 + (i * 7) % 80);
+        }
+        count++;
+    }
+    *commands = count;
+    return len;
+}
+
+// 模拟串口：把队列中的帧全部编码成批并写入内存，返回帧数
+unsigned long drain_to_fake_serial(void) {
+    unsigned long frames = 0;
+    pump.next_due_ns = 0;                       // 不等待宏动作节拍
+    while (serial_pump_fill(&pump, &frame_ring, 0)) {
+        memcpy(serial_sink, pump.data, pump.len);
+        frames += pump.frames;
+        serial_pump_written(&pump, &frame_ring, (ssize_t)pump.len, 0);
+        pump.next_due_ns = 0;
+    }
+    return frames;
+}
+
+int main(int argc, char *argv[]) {
+    int rounds = 200;
+    const char *limits_path = NULL;           // NULL表示使用程序所在目录下的默认配置
+    int opt;
+    while ((opt = getopt(argc, argv, "n:c:")) != -1) {
+        switch (opt) {
+            case 'n':
+                rounds = atoi(optarg);
+                break;
+            case 'c':
+                limits_path = optarg;
+                break;
+            default:
+                fprintf(stderr, "用法: %s [-n 轮数] [-c 限位配置文件]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    command_verbose = 0;
+    load_safety_config(&safety_table, limits_path);
+    ring_init(&frame_ring, 0);
+    reply.fd = -1;
+    conn.throttle = 1;                          // 与中转程序相同：回复缓冲区快满时暂停，下一块时继续
+
+    unsigned long commands_per_round;
+    size_t stream_len = build_stream(stream, sizeof(stream), &commands_per_round);
+
+    // 1. 解析+分发（含限位检查和入队）与 2. 串口编码，按网络读取的大小分块喂入
+    uint64_t parse_ns = 0, encode_ns = 0;
+    unsigned long commands = 0, frames = 0;
+    for (int round = 0; round < rounds; round++) {
+        size_t offset = 0;
+        while (offset < stream_len) {
+            size_t chunk = sizeof(conn.buffer) - (size_t)conn.pending;
+            if (chunk > stream_len - offset) {
+                chunk = stream_len - offset;
+            }
+            memcpy(conn.buffer + conn.pending, stream + offset, chunk);
+            offset += chunk;
+
+            uint64_t t0 = monotonic_ns();
+            handle_client_data(&conn, &reply, &frame_ring, &safety_table, (ssize_t)chunk);
+            uint64_t t1 = monotonic_ns();
+            frames += drain_to_fake_serial();
+            uint64_t t2 = monotonic_ns();
+
+            parse_ns += t1 - t0;
+            encode_ns += t2 - t1;
+            reply.len = 0;
+        }
+        commands += commands_per_round;
+    }
+
+    // 3. 单独测量回复生成（与process_command使用同一个format_joint_ack）
+    unsigned long acks = (unsigned long)rounds * commands_per_round;
+    uint64_t t0 = monotonic_ns();
+    for (unsigned long i = 0; i < acks; i++) {
+        char response[256];
+        format_joint_ack(response, sizeof(response), (unsigned char)(i % 6), (unsigned char)(i % 181));
+        if (reply.len + sizeof(response) > sizeof(reply.data)) {
+            reply.len = 0;
+        }
+        send_response(&reply, response);
+    }
+    uint64_t ack_ns = monotonic_ns() - t0;
+
+    printf("指令流 %zu 字节/轮，%lu 条指令/轮，共 %d 轮\n", stream_len, commands_per_round, rounds);
+    printf("解析+分发: %8.1f ns/指令（%lu 条）\n", (double)parse_ns / commands, commands);
+    printf("串口编码:  %8.1f ns/帧（%lu 帧）\n", frames ? (double)encode_ns / frames : 0.0, frames);
+    printf("回复生成:  %8.1f ns/条（%lu 条）\n", (double)ack_ns / acks, acks);
+
+    char stats[1024];
+    format_safety_stats(&safety_table, stats, sizeof(stats));
+    printf("%s\n", stats);
+    return 0;
+}
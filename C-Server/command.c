@@ -0,0 +1,242 @@
+#include "command.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "serial.h"
+
+// 控制台打印开关，基准测试时关闭
+int command_verbose = 1;
+
+#define CMD_LOG(...) do { if (command_verbose) printf(__VA_ARGS__); } while (0)
+
+// 把缓冲的回复全部发送给客户端
+void flush_responses(reply_buffer_t *reply) {
+    while (reply->off < reply->len) {
+        ssize_t n = write(reply->fd, reply->data + reply->off, reply->len - reply->off);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // 非阻塞的客户端socket（epoll后端）缓冲区满时等待可写，不丢弃回复
+            struct pollfd pfd = { .fd = reply->fd, .events = POLLOUT };
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        if (n <= 0) {
+            perror("发送响应失败");
+            break;
+        }
+        reply->off += n;
+    }
+    reply->len = 0;
+    reply->off = 0;
+}
+
+// 非阻塞地发送缓冲的回复：返回0表示已全部发送，1表示socket缓冲区已满、剩余部分保留在缓冲区中，-1表示连接出错
+int flush_responses_nonblock(reply_buffer_t *reply) {
+    while (reply->off < reply->len) {
+        ssize_t n = send(reply->fd, reply->data + reply->off, reply->len - reply->off, MSG_NOSIGNAL);
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        }
+        if (n <= 0) {
+            perror("发送响应失败");
+            reply->len = 0;
+            reply->off = 0;
+            return -1;
+        }
+        reply->off += n;
+    }
+    reply->len = 0;
+    reply->off = 0;
+    return 0;
+}
+
+// 向客户端发送响应（先放入缓冲区，由后端在处理完本次读取后统一发送）
+// 每条回复以换行结尾，客户端可以连续发送多条指令，再按顺序逐行对应回复
+void send_response(reply_buffer_t *reply, const char *message) {
+    size_t len = strlen(message);
+    if (reply->len + len + 1 > sizeof(reply->data)) {
+        flush_responses(reply);
+    }
+    memcpy(reply->data + reply->len, message, len);
+    reply->len += len;
+    reply->data[reply->len++] = '\n';
+}
+
+// 生成0xAA指令的确认回复（axis为从0开始的轴号）
+void format_joint_ack(char *out, size_t size, unsigned char axis, unsigned char angle) {
+    snprintf(out, size, "指令已收到：轴 %d 的角度设置为 %d°", axis + 1, angle);
+}
+
+// 处理接收到的一条指令（支持0xBB协议和0xAA协议）
+// 返回消耗的字节数；数据不完整时返回0，等待后续数据
+ssize_t process_command(reply_buffer_t *reply, frame_ring_t *ring, safety_table_t *safety, const unsigned char *buffer, ssize_t len) {
+    // 处理特殊字符串指令（quit由网络线程在调用前处理）
+    if (buffer[0] == 'T' || buffer[0] == 'S' || buffer[0] == 'q') {
+        if (len < 4) {
+            return 0;
+        }
+        if (strncmp((char *)buffer, "TEST", 4) == 0) {
+            CMD_LOG("收到TEST指令，回复测试成功\n");
+            send_response(reply, "TEST指令已收到，连接正常");
+            return 4;
+        }
+        if (strncmp((char *)buffer, "STAT", 4) == 0) {
+            char stats[REPLY_LINE_MAX];
+            format_ring_stats(ring, stats, sizeof(stats));
+            size_t used = strlen(stats);
+            stats[used++] = ' ';
+            format_safety_stats(safety, stats + used, sizeof(stats) - used);
+            CMD_LOG("收到STAT指令：%s\n", stats);
+            send_response(reply, stats);
+            return 4;
+        }
+    }
+
+    // 处理0xAA协议
+    if (buffer[0] == 0xAA) {
+        if (len < 3) {
+            return 0;
+        }
+        unsigned char axis = buffer[1];
+        unsigned char angle = buffer[2];
+
+        // 打印指令内容
+        CMD_LOG("收到控制面板指令（0xAA协议）：\n");
+        CMD_LOG("包头: 0xAA\n");
+        CMD_LOG("轴编号: %d\n", axis + 1);
+        CMD_LOG("角度: %d°\n", angle);
+
+        // 在发送给STM32之前检查限位和禁止区
+        if (safety_check(safety, safety->pose, axis, angle) != 0) {
+            char response[256];
+            CMD_LOG("指令被拒绝：%s\n", safety->reason);
+            snprintf(response, sizeof(response), "指令被拒绝：%s", safety->reason);
+            send_response(reply, response);
+            return 3;
+        }
+
+        // 将控制命令交给串口线程发送；队列满被丢弃时姿态保持不变
+        serial_frame_t frame = { { 0xAA, axis, angle }, 3, 0 };
+        if (!ring_push(ring, &frame)) {
+            CMD_LOG("串口队列已满，丢弃该指令\n");
+            send_response(reply, "指令被丢弃：串口队列已满");
+            return 3;
+        }
+        safety->pose[axis] = angle;
+
+        // 向客户端发送确认消息
+        char response[256];
+        format_joint_ack(response, sizeof(response), axis, angle);
+        send_response(reply, response);
+        return 3;
+    }
+
+    // 处理0xBB协议
+    else if (buffer[0] == 0xBB) {
+        if (len < 2) {
+            return 0;
+        }
+        unsigned char command_type = buffer[1];
+
+        // 根据不同的command_type调用对应的动作
+        int rejected;
+        switch (command_type) {
+            case 0x00:  // 全部角度为5A
+                rejected = Reset(ring, safety);
+                break;
+            case 0x01:  // 左转
+                rejected = Down(ring, safety);
+                break;
+            case 0x02:  // 右转
+                rejected = Up(ring, safety);
+                break;
+            case 0x03:  // 抓
+                rejected = Scrach(ring, safety);
+                break;
+            case 0x04:  // 放
+                rejected = Push(ring, safety);
+                break;
+            default:
+                CMD_LOG("未知的命令类型 0x%02X\n", command_type);
+                send_response(reply, "未知的0xBB命令类型");
+                return 2;
+        }
+
+        if (rejected == -2) {
+            CMD_LOG("串口队列已满，丢弃0xBB命令 0x%02X\n", command_type);
+            send_response(reply, "0xBB命令被丢弃：串口队列已满");
+            return 2;
+        }
+        if (rejected) {
+            char response[256];
+            CMD_LOG("0xBB命令 0x%02X 被拒绝：%s\n", command_type, safety->reason);
+            snprintf(response, sizeof(response), "0xBB命令被拒绝：%s", safety->reason);
+            send_response(reply, response);
+            return 2;
+        }
+
+        // 向客户端发送响应（动作已排入串口队列，由串口线程按节拍执行）
+        send_response(reply, "0xBB命令已执行");
+        return 2;
+    }
+
+    // 处理无效包头：丢弃本次收到的剩余数据
+    else {
+        CMD_LOG("无效的包头\n");
+        send_response(reply, "无效的指令包头");
+        return len;
+    }
+}
+
+
+// 帧队列是否还能放下最坏情况的一条指令（MACRO_MAX_FRAMES帧）
+int dispatch_has_room(frame_ring_t *ring) {
+    return FRAME_RING_SIZE - ring_occupancy(ring) >= MACRO_MAX_FRAMES;
+}
+
+// 处理客户端新读到的len字节（一次读取可能包含多条指令，也可能只有半条），返回1表示收到quit
+int handle_client_data(client_conn_t *conn, reply_buffer_t *reply, frame_ring_t *ring, safety_table_t *safety, ssize_t len) {
+    len += conn->pending;
+    conn->pending = 0;
+    conn->stalled = 0;
+    ring_begin_batch(ring);
+
+    // 依次处理并打印接收到的角度控制指令
+    ssize_t offset = 0;
+    while (offset < len) {
+        // 修改quit检测逻辑
+        if (len - offset >= 4 && strncmp(conn->buffer + offset, "quit", 4) == 0) {
+            return 1;
+        }
+
+        // 一次读取最多可以包含几百条宏动作，远超帧队列的容量：队列放不下下一条指令时先停下，
+        // 剩余的指令等串口消费后再处理，而不是丢弃；回复缓冲区快满时同样先停下，等回复发出
+        if (conn->throttle && (!dispatch_has_room(ring) || sizeof(reply->data) - reply->len < REPLY_LINE_MAX)) {
+            conn->stalled = 1;
+            break;
+        }
+
+        ssize_t used = process_command(reply, ring, safety, (unsigned char *)conn->buffer + offset, len - offset);
+        if (used == 0) {
+            break;
+        }
+        offset += used;
+    }
+
+    // 保留不完整的指令（或暂停分发后剩余的指令），与下一次读取的数据拼接
+    if (offset < len) {
+        conn->pending = len - offset;
+        memmove(conn->buffer, conn->buffer + offset, conn->pending);
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <sys/types.h>
+
+#include "frame_ring.h"
+#include "safety.h"
+
+#define REPLY_BUFFER_SIZE 16384        // 回复缓冲区（io_uring后端要注册两个，需留在默认的64 KiB锁定内存限制内）
+#define REPLY_LINE_MAX 1024            // 单条回复的最大长度（含换行，STAT最长）
+
+// 客户端回复缓冲区：一次读取中所有指令的回复合并后一次发送
+typedef struct {
+    int fd;
+    size_t len;
+    size_t off;                              // 已发送的字节数（io_uring部分发送时使用）
+    char data[REPLY_BUFFER_SIZE];
+} reply_buffer_t;
+
+// 客户端连接：保存跨读取的半条指令
+typedef struct {
+    int fd;
+    ssize_t pending;
+    int throttle;             // 帧队列或回复缓冲区放不下最坏情况的一条指令时暂停分发（由后端设置）
+    int stalled;              // 分发已暂停，buffer中还有未处理的完整指令，期间不应读取客户端
+    char buffer[1024];
+} client_conn_t;
+
+// 是否在控制台打印每条指令（默认打开）
+extern int command_verbose;
+
+// 把缓冲的回复全部发送给客户端
+void flush_responses(reply_buffer_t *reply);
+// 非阻塞地发送缓冲的回复：返回0表示已全部发送，1表示还有剩余（等待可写后再调用），-1表示连接出错
+int flush_responses_nonblock(reply_buffer_t *reply);
+// 向客户端发送一行响应（先放入缓冲区，由后端在处理完本次读取后统一发送）
+// 除无效包头外，每条指令都对应一行回复
+void send_response(reply_buffer_t *reply, const char *message);
+
+// 生成0xAA指令的确认回复（axis为从0开始的轴号）
+void format_joint_ack(char *out, size_t size, unsigned char axis, unsigned char angle);
+
+// 处理接收到的一条指令（支持0xBB协议和0xAA协议）
+// 返回消耗的字节数；数据不完整时返回0，等待后续数据
+ssize_t process_command(reply_buffer_t *reply, frame_ring_t *ring, safety_table_t *safety, const unsigned char *buffer, ssize_t len);
+// 帧队列是否还能放下最坏情况的一条指令（MACRO_MAX_FRAMES帧）
+int dispatch_has_room(frame_ring_t *ring);
+// 处理客户端新读到的len字节（一次读取可能包含多条指令，也可能只有半条），返回1表示收到quit
+// conn->throttle为1时，帧队列或回复缓冲区空间不足就停止分发并设置conn->stalled，剩余数据留在buffer中；
+// 之后由后端在回复发出、dispatch_has_room成立时以len=0再次调用，继续处理剩余的指令
+int handle_client_data(client_conn_t *conn, reply_buffer_t *reply, frame_ring_t *ring, safety_table_t *safety, ssize_t len);
+
+#endif // COMMAND_H
@@ -4,68 +4,43 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 
-#define PORT 6657
+#include "frame_ring.h"
+#include "safety.h"
+#include "serial.h"
+#include "command.h"
 
-// 向客户端发送响应
-void send_response(int client_fd, const char *message) {
-    ssize_t len = strlen(message);
-    if (write(client_fd, message, len) != len) {
-        perror("发送响应失败");
-    }
-}
-
-// 解析接收到的指令并打印角度信息
-void process_command(int client_fd, const unsigned char *buffer, ssize_t len) {
-    if (len < 3) {
-        printf("指令数据不完整\n");
-        return;
-    }
-
-    // 如果接收到 "TEST" 指令
-    if (strncmp((char *)buffer, "TEST", 4) == 0) {
-        printf("收到 TEST 指令\n");
+#define PORT 6657
 
-        // 向客户端发送响应
-        send_response(client_fd, "测试指令收到\n");
-        return;
-    }
+static frame_ring_t frame_ring;
+static safety_table_t safety_table;
 
-    // 检查包头
-    if (buffer[0] != 0xAA) {
-        printf("无效的包头\n");
-        return;
-    }
-
-    // 指令类型（第二个字节，轴号）
-    unsigned char axis = buffer[1];
-    if (axis > 5) {
-        printf("无效的轴号\n");
-        return;
+// 模拟串口：把队列中的帧打印出来，不连接STM32
+void print_serial_frames(frame_ring_t *ring) {
+    serial_frame_t frame;
+    while (ring_try_pop(ring, &frame)) {
+        printf("串口帧:");
+        for (int i = 0; i < frame.len; i++) {
+            printf(" %02X", frame.data[i]);
+        }
+        if (frame.delay_us > 0) {
+            printf("（之后等待 %u ms）", frame.delay_us / 1000);
+        }
+        printf("\n");
+        atomic_fetch_add_explicit(&ring->frames_written, 1, memory_order_relaxed);
     }
-
-    // 角度数据（第三个字节）
-    unsigned char angle = buffer[2];
-
-    // 打印指令内容
-    printf("收到控制面板指令：\n");
-    printf("包头: 0xAA\n");
-    printf("轴编号: %d\n", axis);  // 轴编号从0开始
-    printf("角度: %d°\n", angle);
-
-    // 向客户端发送确认消息
-    char response[256];
-    snprintf(response, sizeof(response), "指令已收到：轴 %d 的角度设置为 %d°", axis + 1, angle);  // 客户端显示1~6的轴号
-    send_response(client_fd, response);
 }
 
 // 监听并接收控制面板指令
-void listen_and_debug() {
-    int server_fd, client_fd;
-    struct sockaddr_in server_addr, client_addr;
-    socklen_t addr_len = sizeof(client_addr);
-    char buffer[1024];
+void listen_and_debug(const char *limits_path) {
+    int server_fd;
+    struct sockaddr_in server_addr;
+    static client_conn_t conn;
+    static reply_buffer_t reply;
     ssize_t len;
 
+    load_safety_config(&safety_table, limits_path);
+    ring_init(&frame_ring, 0);
+
     // 创建TCP socket
     if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
         perror("创建socket失败");
@@ -80,6 +55,7 @@ void listen_and_debug() {
         exit(1);
     }
 
+    memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY; // 监听所有可用的网络接口
     server_addr.sin_port = htons(PORT);
@@ -98,20 +74,27 @@ void listen_and_debug() {
         exit(1);
     }
 
-    printf("网络调试程序已启动，监听端口 %d...\n", PORT);
+    printf("网络调试程序已启动（模拟串口），监听端口 %d...\n", PORT);
 
     while (1) {
         // 接受客户端连接
-        if ((client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &addr_len)) == -1) {
+        if ((conn.fd = accept(server_fd, NULL, NULL)) == -1) {
             perror("接受连接失败");
             continue;
         }
         printf("客户端已连接\n");
-
-        // 读取客户端数据
-        while ((len = read(client_fd, buffer, sizeof(buffer))) > 0) {
-            // 处理并打印接收到的角度控制指令
-            process_command(client_fd, (unsigned char *)buffer, len);
+        conn.pending = 0;
+        reply.fd = conn.fd;
+        reply.len = reply.off = 0;
+
+        // 读取客户端数据，与中转程序使用同一套解析和分发逻辑
+        while ((len = read(conn.fd, conn.buffer + conn.pending, sizeof(conn.buffer) - conn.pending)) > 0) {
+            if (handle_client_data(&conn, &reply, &frame_ring, &safety_table, len)) {
+                printf("收到quit指令，调试程序不退出\n");
+                send_response(&reply, "调试程序收到quit指令");
+            }
+            print_serial_frames(&frame_ring);
+            flush_responses(&reply);
         }
 
         if (len == 0) {
@@ -121,14 +104,15 @@ void listen_and_debug() {
         }
 
         // 关闭客户端连接
-        close(client_fd);
+        close(conn.fd);
     }
 
     // 关闭服务器socket
     close(server_fd);
 }
 
-int main() {
-    listen_and_debug();
+// 用法: debugmain [限位配置文件]
+int main(int argc, char *argv[]) {
+    listen_and_debug(argc > 1 ? argv[1] : NULL);
     return 0;
 }
@@ -0,0 +1,130 @@
+#include "frame_ring.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
+// 初始化环形队列；单线程后端中生产者和消费者是同一个线程，push_timeout_us必须为0
+void ring_init(frame_ring_t *ring, int push_timeout_us) {
+    memset(ring, 0, sizeof(*ring));
+    ring->push_timeout_us = push_timeout_us;
+    ring->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (ring->wake_fd == -1) {
+        perror("创建eventfd失败");
+        exit(1);
+    }
+}
+
+// 当前队列占用
+size_t ring_occupancy(frame_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+// 尝试写入一帧，队列满时返回0
+int ring_try_push(frame_ring_t *ring, const serial_frame_t *frame) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= FRAME_RING_SIZE) {
+        return 0;
+    }
+    ring->slots[head & (FRAME_RING_SIZE - 1)] = *frame;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_seq_cst);
+
+    size_t used = head + 1 - tail;
+    if (used > atomic_load_explicit(&ring->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&ring->high_water, used, memory_order_relaxed);
+    }
+    return 1;
+}
+
+// 尝试读取一帧，队列空时返回0
+int ring_try_pop(frame_ring_t *ring, serial_frame_t *frame) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == head) {
+        return 0;
+    }
+    *frame = ring->slots[tail & (FRAME_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+// 唤醒正在等待的串口线程
+void ring_wake_consumer(frame_ring_t *ring) {
+    if (atomic_load_explicit(&ring->consumer_waiting, memory_order_seq_cst)) {
+        uint64_t one = 1;
+        if (write(ring->wake_fd, &one, sizeof(one)) != sizeof(one)) {
+            perror("唤醒串口线程失败");
+        }
+    }
+}
+
+// 开始处理一次读取的数据：清除上一批的超时标记
+void ring_begin_batch(frame_ring_t *ring) {
+    ring->batch_timed_out = 0;
+}
+
+// 入队一组帧，空间足够放下全部帧时才写入，否则整组丢弃并计入统计，返回是否入队
+// 队列满时短暂等待串口线程消费；同一批中超时一次后，后续的帧不再等待，网络线程每次读取最多被阻塞push_timeout_us
+int ring_push_frames(frame_ring_t *ring, const serial_frame_t *frames, int count) {
+    int waited_us = 0;
+    int stalled = 0;
+    while (FRAME_RING_SIZE - ring_occupancy(ring) < (size_t)count) {
+        if (!stalled) {
+            atomic_fetch_add_explicit(&ring->push_stalls, 1, memory_order_relaxed);
+            stalled = 1;
+        }
+        if (ring->batch_timed_out || waited_us >= ring->push_timeout_us) {
+            ring->batch_timed_out = 1;
+            atomic_fetch_add_explicit(&ring->drops, (unsigned long)count, memory_order_relaxed);
+            return 0;
+        }
+        ring_wake_consumer(ring);
+        usleep(RING_PUSH_RETRY_US);
+        waited_us += RING_PUSH_RETRY_US;
+    }
+    // 只有串口线程会腾出空间，这里一定能全部写入
+    for (int i = 0; i < count; i++) {
+        ring_try_push(ring, &frames[i]);
+    }
+    return 1;
+}
+
+// 入队一帧，规则同ring_push_frames
+int ring_push(frame_ring_t *ring, const serial_frame_t *frame) {
+    return ring_push_frames(ring, frame, 1);
+}
+
+// 读取一帧，队列空时阻塞等待网络线程唤醒
+void ring_pop_wait(frame_ring_t *ring, serial_frame_t *frame) {
+    while (!ring_try_pop(ring, frame)) {
+        atomic_store_explicit(&ring->consumer_waiting, 1, memory_order_seq_cst);
+        if (ring_try_pop(ring, frame)) {
+            atomic_store_explicit(&ring->consumer_waiting, 0, memory_order_relaxed);
+            return;
+        }
+        uint64_t value;
+        if (read(ring->wake_fd, &value, sizeof(value)) == -1 && errno != EINTR) {
+            perror("等待串口队列失败");
+        }
+        atomic_store_explicit(&ring->consumer_waiting, 0, memory_order_relaxed);
+    }
+}
+
+// 生成队列统计信息
+void format_ring_stats(frame_ring_t *ring, char *out, size_t size) {
+    snprintf(out, size,
+             "队列占用 %zu/%d，峰值 %zu，入队阻塞 %lu 次，丢弃 %lu 帧，串口阻塞 %lu 次，已写入 %lu 帧，写入失败 %lu 帧",
+             ring_occupancy(ring), FRAME_RING_SIZE,
+             atomic_load_explicit(&ring->high_water, memory_order_relaxed),
+             atomic_load_explicit(&ring->push_stalls, memory_order_relaxed),
+             atomic_load_explicit(&ring->drops, memory_order_relaxed),
+             atomic_load_explicit(&ring->write_stalls, memory_order_relaxed),
+             atomic_load_explicit(&ring->frames_written, memory_order_relaxed),
+             atomic_load_explicit(&ring->frames_failed, memory_order_relaxed));
+}
@@ -0,0 +1,61 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define FRAME_RING_SIZE 1024           // 帧环形队列容量（必须为2的幂）
+#define RING_PUSH_RETRY_US 200         // 队列满时每次重试的等待时间
+#define RING_PUSH_TIMEOUT_US 20000     // 队列满时最长等待时间，超时则丢弃该帧
+
+// 预先编码好的串口帧
+typedef struct {
+    unsigned char data[3];
+    unsigned char len;
+    unsigned int delay_us;    // 写入后等待的时间（用于宏动作的节拍）
+} serial_frame_t;
+
+// 单生产者单消费者无锁环形队列：网络线程写入，串口线程读取
+typedef struct {
+    _Alignas(64) _Atomic size_t head;       // 下一个写入位置（仅网络线程修改）
+    _Alignas(64) _Atomic size_t tail;       // 下一个读取位置（仅串口线程修改）
+    _Alignas(64) _Atomic int consumer_waiting;  // 串口线程是否在等待唤醒
+    int wake_fd;                            // 唤醒串口线程用的eventfd
+    int push_timeout_us;                    // 队列满时入队的最长等待时间
+    int batch_timed_out;                    // 本次读取中已有入队超时，剩余的帧不再等待（仅生产者访问）
+
+    // 统计信息
+    _Atomic size_t high_water;              // 队列占用峰值
+    _Atomic unsigned long push_stalls;      // 入队时遇到队列满的次数
+    _Atomic unsigned long drops;            // 等待超时后丢弃的帧数
+    _Atomic unsigned long write_stalls;     // 串口写入阻塞（EAGAIN/部分写入）的次数
+    _Atomic unsigned long frames_written;   // 已写入串口的帧数
+    _Atomic unsigned long frames_failed;    // 串口写入出错而丢失的帧数
+
+    serial_frame_t slots[FRAME_RING_SIZE];
+} frame_ring_t;
+
+// 初始化环形队列；单线程后端中生产者和消费者是同一个线程，push_timeout_us必须为0
+void ring_init(frame_ring_t *ring, int push_timeout_us);
+// 当前队列占用
+size_t ring_occupancy(frame_ring_t *ring);
+// 尝试写入一帧，队列满时返回0
+int ring_try_push(frame_ring_t *ring, const serial_frame_t *frame);
+// 尝试读取一帧，队列空时返回0
+int ring_try_pop(frame_ring_t *ring, serial_frame_t *frame);
+// 唤醒正在等待的串口线程
+void ring_wake_consumer(frame_ring_t *ring);
+// 开始处理一次读取的数据：清除上一批的超时标记
+void ring_begin_batch(frame_ring_t *ring);
+// 入队一组帧，空间足够放下全部帧时才写入，否则整组丢弃并计入统计，返回是否入队
+// 队列满时短暂等待串口线程消费；同一批中超时一次后，后续的帧不再等待，网络线程每次读取最多被阻塞push_timeout_us
+int ring_push_frames(frame_ring_t *ring, const serial_frame_t *frames, int count);
+// 入队一帧，规则同ring_push_frames
+int ring_push(frame_ring_t *ring, const serial_frame_t *frame);
+// 读取一帧，队列空时阻塞等待网络线程唤醒
+void ring_pop_wait(frame_ring_t *ring, serial_frame_t *frame);
+
+// 生成队列统计信息
+void format_ring_stats(frame_ring_t *ring, char *out, size_t size);
+
+#endif // FRAME_RING_H
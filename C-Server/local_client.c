@@ -0,0 +1,118 @@
+#include "local_client.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// 连接中转程序并映射共享内存队列，失败返回-1
+int local_producer_open(local_producer_t *producer, const char *path) {
+    struct sockaddr_un addr;
+    memset(producer, 0, sizeof(*producer));
+    producer->sock_fd = -1;
+    producer->event_fd = -1;
+
+    producer->sock_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (producer->sock_fd == -1) {
+        perror("创建本地socket失败");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    if (connect(producer->sock_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+        perror("连接中转程序失败");
+        local_producer_close(producer);
+        return -1;
+    }
+
+    // 握手：申请共享内存通道，回复中带有memfd和eventfd
+    if (write(producer->sock_fd, LOCAL_SHM_HELLO, 4) != 4) {
+        perror("发送握手失败");
+        local_producer_close(producer);
+        return -1;
+    }
+
+    char reply[16];
+    int fds[2];
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = { reply, sizeof(reply) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t len = recvmsg(producer->sock_fd, &msg, MSG_CMSG_CLOEXEC);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (len < (ssize_t)strlen(LOCAL_SHM_REPLY) || strncmp(reply, LOCAL_SHM_REPLY, strlen(LOCAL_SHM_REPLY)) != 0 ||
+        cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN(sizeof(fds))) {
+        fprintf(stderr, "中转程序拒绝了共享内存通道\n");
+        local_producer_close(producer);
+        return -1;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    producer->event_fd = fds[1];
+
+    void *shared = mmap(NULL, sizeof(shm_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    if (shared == MAP_FAILED) {
+        perror("映射共享内存失败");
+        local_producer_close(producer);
+        return -1;
+    }
+    producer->ring = shared;
+    if (producer->ring->magic != SHM_RING_MAGIC || producer->ring->size != SHM_RING_SIZE) {
+        fprintf(stderr, "共享内存队列版本不匹配\n");
+        local_producer_close(producer);
+        return -1;
+    }
+    return 0;
+}
+
+// 发送一条指令（0xAA/0xBB帧），队列满时返回-1
+int local_producer_send(local_producer_t *producer, const unsigned char *command, size_t len) {
+    if (shm_ring_push(producer->ring, command, len) != 0) {
+        return -1;
+    }
+    shm_ring_notify(producer->ring, producer->event_fd);
+    return 0;
+}
+
+// 设置单个轴的角度
+int local_producer_set_joint(local_producer_t *producer, unsigned char axis, unsigned char angle) {
+    unsigned char command[3] = { 0xAA, axis, angle };
+    return local_producer_send(producer, command, sizeof(command));
+}
+
+// 一次设置全部6个轴的角度，只唤醒中转程序一次；队列放不下整个姿态时一条也不写，返回-1
+int local_producer_set_pose(local_producer_t *producer, const unsigned char *angles) {
+    if (shm_ring_space(producer->ring) < 6) {
+        shm_ring_notify(producer->ring, producer->event_fd);
+        return -1;
+    }
+    for (unsigned char axis = 0; axis < 6; axis++) {
+        unsigned char command[3] = { 0xAA, axis, angles[axis] };
+        shm_ring_push(producer->ring, command, sizeof(command));
+    }
+    shm_ring_notify(producer->ring, producer->event_fd);
+    return 0;
+}
+
+// 断开连接并释放共享内存
+void local_producer_close(local_producer_t *producer) {
+    if (producer->ring != NULL) {
+        munmap(producer->ring, sizeof(shm_ring_t));
+        producer->ring = NULL;
+    }
+    if (producer->event_fd != -1) {
+        close(producer->event_fd);
+        producer->event_fd = -1;
+    }
+    if (producer->sock_fd != -1) {
+        close(producer->sock_fd);
+        producer->sock_fd = -1;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef LOCAL_CLIENT_H
+#define LOCAL_CLIENT_H
+
+#include <stddef.h>
+
+#include "shm_ring.h"
+
+// 本机生产者（视觉、自动化程序）：通过Unix域socket握手，之后直接把指令写入共享内存队列
+// 共享内存通道没有回复，被限位拒绝的指令只体现在中转程序的STAT统计中
+typedef struct {
+    int sock_fd;              // 保持连接，断开即表示生产者退出
+    int event_fd;             // 唤醒中转程序
+    shm_ring_t *ring;
+} local_producer_t;
+
+// 连接中转程序并映射共享内存队列，失败返回-1
+int local_producer_open(local_producer_t *producer, const char *path);
+// 发送一条指令（0xAA/0xBB帧），队列满时返回-1
+int local_producer_send(local_producer_t *producer, const unsigned char *command, size_t len);
+// 设置单个轴的角度
+int local_producer_set_joint(local_producer_t *producer, unsigned char axis, unsigned char angle);
+// 一次设置全部6个轴的角度，只唤醒中转程序一次；队列放不下整个姿态时一条也不写，返回-1
+int local_producer_set_pose(local_producer_t *producer, const unsigned char *angles);
+// 断开连接并释放共享内存
+void local_producer_close(local_producer_t *producer);
+
+#endif // LOCAL_CLIENT_H
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "local_client.h"
+
+// 本机生产者示例：通过共享内存通道连续发送6轴姿态，用于验证本地传输和压测
+// 用法: relay_local_send [-s 本地socket路径] [-n 姿态数] [-r 每秒姿态数，0为不限速]
+
+#define SEND_RETRY_US 200              // 共享内存队列满时的重试间隔
+
+// 当前时间（纳秒）
+uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = LOCAL_SOCKET_PATH;
+    long poses = 1000;
+    long rate = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:r:")) != -1) {
+        switch (opt) {
+            case 's':
+                path = optarg;
+                break;
+            case 'n':
+                poses = atol(optarg);
+                break;
+            case 'r':
+                rate = atol(optarg);
+                break;
+            default:
+                fprintf(stderr, "用法: %s [-s 本地socket路径] [-n 姿态数] [-r 每秒姿态数]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    local_producer_t producer;
+    if (local_producer_open(&producer, path) != 0) {
+        return 1;
+    }
+
+    // 各轴在90度附近来回摆动，保持在默认限位和禁区之外
+    long stalls = 0;
+    uint64_t start = now_ns();
+    for (long i = 0; i < poses; i++) {
+        unsigned char angles[6];
+        unsigned char offset = (unsigned char)(i % 40);
+        for (int axis = 0; axis < 6; axis++) {
+            angles[axis] = (unsigned char)(70 + (offset + axis * 5) % 40);
+        }
+        // 队列满说明串口跟不上，等中转程序消费后重试，不丢姿态
+        while (local_producer_set_pose(&producer, angles) != 0) {
+            stalls++;
+            usleep(SEND_RETRY_US);
+        }
+        if (rate > 0) {
+            uint64_t due = start + (uint64_t)(i + 1) * 1000000000ull / (uint64_t)rate;
+            uint64_t now = now_ns();
+            if (due > now) {
+                usleep((useconds_t)((due - now) / 1000));
+            }
+        }
+    }
+    double elapsed = (double)(now_ns() - start) / 1e9;
+
+    printf("已发送 %ld 个姿态（%ld 条指令），用时 %.3f s，%.0f 条/秒，队列满等待 %ld 次\n",
+           poses, poses * 6, elapsed, elapsed > 0 ? poses * 6 / elapsed : 0.0, stalls);
+    local_producer_close(&producer);
+    return 0;
+}
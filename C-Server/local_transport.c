@@ -0,0 +1,394 @@
+#include "local_transport.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "shm_ring.h"
+
+// epoll事件标识：高32位为类型，低32位为客户端编号
+enum {
+    LOCAL_EVENT_LISTEN = 1,
+    LOCAL_EVENT_SOCKET,
+    LOCAL_EVENT_SHM,
+};
+
+#define LOCAL_EVENT(type, index) (((uint64_t)(type) << 32) | (uint32_t)(index))
+
+// 本地客户端
+typedef struct {
+    int fd;                   // -1表示连接已断开；shm_mode仍为1时共享内存中还有指令未处理完，槽位尚未空闲
+    int shm_mode;             // 1表示已切换到共享内存通道
+    int event_fd;
+    shm_ring_t *shm;
+    uint32_t events;          // 当前为socket监听的事件
+    client_conn_t conn;
+    reply_buffer_t reply;     // 每个客户端单独缓冲，发不完的回复留到socket可写时再发
+} local_client_t;
+
+static local_client_t local_clients[LOCAL_MAX_CLIENTS];
+static reply_buffer_t local_discard;     // 共享内存通道没有回复，丢弃
+static int local_epoll_fd;
+static int local_listen_fd;
+
+// 添加epoll监听的文件
+void local_epoll_add(int fd, uint64_t tag) {
+    struct epoll_event ev = { .events = EPOLLIN, .data = { .u64 = tag } };
+    if (epoll_ctl(local_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+        perror("epoll_ctl失败");
+    }
+}
+
+// 为客户端创建共享内存队列，并通过SCM_RIGHTS把memfd和eventfd交给它
+int local_client_setup_shm(local_client_t *client, int index) {
+    int mem_fd = memfd_create("robot-arm-shm-ring", MFD_CLOEXEC);
+    if (mem_fd == -1) {
+        perror("创建共享内存失败");
+        return -1;
+    }
+    if (ftruncate(mem_fd, sizeof(shm_ring_t)) == -1) {
+        perror("设置共享内存大小失败");
+        close(mem_fd);
+        return -1;
+    }
+    void *shared = mmap(NULL, sizeof(shm_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+    if (shared == MAP_FAILED) {
+        perror("映射共享内存失败");
+        close(mem_fd);
+        return -1;
+    }
+    int event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd == -1) {
+        perror("创建eventfd失败");
+        munmap(shared, sizeof(shm_ring_t));
+        close(mem_fd);
+        return -1;
+    }
+    shm_ring_init(shared);
+
+    int fds[2] = { mem_fd, event_fd };
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+    struct iovec iov = { (void *)LOCAL_SHM_REPLY, strlen(LOCAL_SHM_REPLY) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+    ssize_t sent = sendmsg(client->fd, &msg, MSG_NOSIGNAL);
+    close(mem_fd);
+    if (sent == -1) {
+        perror("发送共享内存失败");
+        close(event_fd);
+        munmap(shared, sizeof(shm_ring_t));
+        return -1;
+    }
+
+    client->shm = shared;
+    client->event_fd = event_fd;
+    client->shm_mode = 1;
+    local_epoll_add(event_fd, LOCAL_EVENT(LOCAL_EVENT_SHM, index));
+    printf("本地客户端已切换到共享内存通道\n");
+    return 0;
+}
+
+// 帧队列是否还有空间（留出宏动作的余量）
+int local_frame_room(local_transport_args_t *args) {
+    return ring_occupancy(args->ring) + LOCAL_FRAME_HEADROOM <= FRAME_RING_SIZE;
+}
+
+// 处理一个客户端共享内存队列中的指令（调用方持有dispatch_lock）
+// 帧队列快满时停止，剩余指令留在共享内存队列中，由生产者感知到队列满
+int local_drain_client(local_transport_args_t *args, local_client_t *client) {
+    int dispatched = 0;
+    shm_command_t command;
+    for (int n = 0; n < LOCAL_DRAIN_BATCH && local_frame_room(args) && shm_ring_pop(client->shm, &command); n++) {
+        process_command(&local_discard, args->ring, args->safety, command.data, command.len);
+        local_discard.len = 0;
+        dispatched++;
+    }
+    return dispatched;
+}
+
+// 释放已断开客户端的共享内存队列，槽位重新空闲
+void local_client_release_shm(local_client_t *client) {
+    epoll_ctl(local_epoll_fd, EPOLL_CTL_DEL, client->event_fd, NULL);
+    close(client->event_fd);
+    munmap(client->shm, sizeof(shm_ring_t));
+    client->shm = NULL;
+    client->shm_mode = 0;
+    printf("本地客户端共享内存中的指令已处理完\n");
+}
+
+// 处理所有共享内存队列中的指令：与TCP指令走同一套分发逻辑，回复直接丢弃
+// 已断开的客户端的剩余指令也在这里和其他客户端轮流处理，处理完后释放
+// 返回是否因为帧队列快满而留下了未处理的指令
+int local_drain_shm(local_transport_args_t *args) {
+    int backlog = 0;
+    int dispatched = 0;
+    pthread_mutex_lock(args->dispatch_lock);
+    for (int i = 0; i < LOCAL_MAX_CLIENTS; i++) {
+        local_client_t *client = &local_clients[i];
+        if (client->shm_mode) {
+            dispatched += local_drain_client(args, client);
+            if (!shm_ring_pending(client->shm)) {
+                if (client->fd == -1) {
+                    local_client_release_shm(client);
+                }
+            } else if (!local_frame_room(args)) {
+                backlog = 1;
+            }
+        }
+    }
+    pthread_mutex_unlock(args->dispatch_lock);
+    if (dispatched) {
+        ring_wake_consumer(args->ring);
+    }
+    return backlog;
+}
+
+// 关闭本地客户端；共享内存中剩余的指令由local_drain_shm继续处理，不在这里等待
+void local_client_close(local_client_t *client) {
+    epoll_ctl(local_epoll_fd, EPOLL_CTL_DEL, client->fd, NULL);
+    close(client->fd);
+    client->fd = -1;
+    printf("本地客户端已断开连接\n");
+}
+
+// 按回复和分发状态设置socket监听的事件：回复没发完时只等待可写，分发暂停时不读取
+void local_client_update_events(local_client_t *client, int index) {
+    uint32_t want = EPOLLIN;
+    if (client->reply.off < client->reply.len) {
+        want = EPOLLOUT;
+    } else if (client->conn.stalled) {
+        want = 0;
+    }
+    if (want != client->events) {
+        client->events = want;
+        struct epoll_event ev = { .events = want, .data = { .u64 = LOCAL_EVENT(LOCAL_EVENT_SOCKET, index) } };
+        if (epoll_ctl(local_epoll_fd, EPOLL_CTL_MOD, client->fd, &ev) == -1) {
+            perror("epoll_ctl失败");
+        }
+    }
+}
+
+// 分发普通本地连接的数据（len=0表示继续处理暂停时留下的指令），然后尽量发送回复
+void local_client_dispatch(local_transport_args_t *args, local_client_t *client, int index, ssize_t len) {
+    pthread_mutex_lock(args->dispatch_lock);
+    int quit = handle_client_data(&client->conn, &client->reply, args->ring, args->safety, len);
+    pthread_mutex_unlock(args->dispatch_lock);
+    if (quit) {
+        args->quit(&client->reply);
+    }
+    ring_wake_consumer(args->ring);
+    // 发不完的部分留在缓冲区，等待EPOLLOUT，不阻塞本地传输线程
+    if (flush_responses_nonblock(&client->reply) == -1) {
+        local_client_close(client);
+        return;
+    }
+    local_client_update_events(client, index);
+}
+
+// 帧队列腾出空间后，继续处理暂停分发的普通本地连接；返回是否还有客户端在等帧队列的空间
+int local_resume_stalled(local_transport_args_t *args) {
+    int waiting = 0;
+    for (int i = 0; i < LOCAL_MAX_CLIENTS; i++) {
+        local_client_t *client = &local_clients[i];
+        if (client->fd == -1 || client->shm_mode || !client->conn.stalled || client->reply.len != 0) {
+            continue;
+        }
+        if (dispatch_has_room(args->ring)) {
+            local_client_dispatch(args, client, i, 0);
+        }
+        if (client->fd != -1 && client->conn.stalled && client->reply.len == 0) {
+            waiting = 1;
+        }
+    }
+    return waiting;
+}
+
+// 标记是否在等待eventfd；返回是否还有未处理的指令
+int local_set_waiting(int waiting) {
+    int pending = 0;
+    for (int i = 0; i < LOCAL_MAX_CLIENTS; i++) {
+        local_client_t *client = &local_clients[i];
+        if (client->shm_mode) {
+            atomic_store_explicit(&client->shm->consumer_waiting, (uint32_t)waiting, memory_order_seq_cst);
+            if (waiting && shm_ring_pending(client->shm)) {
+                pending = 1;
+            }
+        }
+    }
+    return pending;
+}
+
+// 读取普通本地连接的数据，首次读取时判断是否申请共享内存通道
+void local_client_read(local_transport_args_t *args, local_client_t *client, int index) {
+    ssize_t len = read(client->fd, client->conn.buffer + client->conn.pending,
+                       sizeof(client->conn.buffer) - client->conn.pending);
+    if (len == -1 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (len <= 0) {
+        if (len < 0) {
+            perror("读取本地数据失败");
+        }
+        local_client_close(client);
+        return;
+    }
+    if (client->shm_mode) {
+        return;               // 共享内存通道的socket只用于检测断开
+    }
+    if (client->conn.pending == 0 && len == 4 && strncmp(client->conn.buffer, LOCAL_SHM_HELLO, 4) == 0) {
+        if (local_client_setup_shm(client, index) != 0) {
+            local_client_close(client);
+        }
+        return;
+    }
+    local_client_dispatch(args, client, index, len);
+}
+
+// 本地传输线程
+void *local_transport_thread(void *arg) {
+    local_transport_args_t *args = (local_transport_args_t *)arg;
+    struct epoll_event events[LOCAL_MAX_CLIENTS + 1];
+    int backlog = 0;
+    int stalled = 0;
+
+    while (1) {
+        // 先声明在等待再检查队列，生产者写入后一定能看到标记并唤醒
+        // 帧队列快满时不能靠eventfd唤醒，定时重新检查
+        int pending = local_set_waiting(1);
+        int timeout = backlog || stalled ? LOCAL_BACKOFF_MS : (pending ? 0 : -1);
+        int count = epoll_wait(local_epoll_fd, events, LOCAL_MAX_CLIENTS + 1, timeout);
+        local_set_waiting(0);
+        if (atomic_load(args->quitting)) {
+            args->quit(NULL);  // 网络后端已收到quit，不再处理新指令，等待退出
+        }
+        if (count == -1) {
+            if (errno != EINTR) {
+                perror("epoll_wait失败");
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int type = (int)(events[i].data.u64 >> 32);
+            int index = (int)(uint32_t)events[i].data.u64;
+            if (type == LOCAL_EVENT_LISTEN) {
+                int fd = accept4(local_listen_fd, NULL, NULL, SOCK_CLOEXEC);
+                if (fd == -1) {
+                    perror("接受本地连接失败");
+                    continue;
+                }
+                int slot = -1;
+                for (int j = 0; j < LOCAL_MAX_CLIENTS; j++) {
+                    if (local_clients[j].fd == -1 && !local_clients[j].shm_mode) {
+                        slot = j;
+                        break;
+                    }
+                }
+                if (slot == -1) {
+                    fprintf(stderr, "本地客户端过多，拒绝连接\n");
+                    close(fd);
+                    continue;
+                }
+                // 客户端不及时读取回复时，写回复不能阻塞其他客户端和共享内存队列的处理
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                local_client_t *client = &local_clients[slot];
+                memset(client, 0, sizeof(*client));
+                client->fd = fd;
+                client->event_fd = -1;
+                client->events = EPOLLIN;
+                client->conn.fd = fd;
+                client->conn.throttle = 1;       // 与TCP后端相同：帧队列满时暂停分发，而不是回复丢弃
+                client->reply.fd = fd;
+                local_epoll_add(fd, LOCAL_EVENT(LOCAL_EVENT_SOCKET, slot));
+                printf("本地客户端已连接\n");
+            } else if (type == LOCAL_EVENT_SOCKET) {
+                local_client_t *client = &local_clients[index];
+                if (client->fd == -1) {
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) {
+                    // 继续发送上次没发完的回复
+                    if (flush_responses_nonblock(&client->reply) == -1) {
+                        local_client_close(client);
+                    } else {
+                        local_client_update_events(client, index);
+                    }
+                } else {
+                    local_client_read(args, client, index);
+                }
+            } else if (type == LOCAL_EVENT_SHM && local_clients[index].shm_mode) {
+                uint64_t value;
+                if (read(local_clients[index].event_fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+                    perror("读取eventfd失败");
+                }
+            }
+        }
+
+        // 处理所有共享内存队列，再继续暂停分发的普通连接
+        backlog = local_drain_shm(args);
+        stalled = local_resume_stalled(args);
+    }
+    return NULL;
+}
+
+// 监听本地Unix域socket并启动本地传输线程
+int local_transport_start(local_transport_args_t *args) {
+    struct sockaddr_un addr;
+    for (int i = 0; i < LOCAL_MAX_CLIENTS; i++) {
+        local_clients[i].fd = -1;
+    }
+
+    local_listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (local_listen_fd == -1) {
+        perror("创建本地socket失败");
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", args->path);
+    unlink(args->path);       // 清理上次异常退出留下的socket文件
+    if (bind(local_listen_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(local_listen_fd, LOCAL_MAX_CLIENTS) == -1) {
+        perror("监听本地socket失败");
+        close(local_listen_fd);
+        return -1;
+    }
+
+    local_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (local_epoll_fd == -1) {
+        perror("创建epoll失败");
+        close(local_listen_fd);
+        return -1;
+    }
+    local_epoll_add(local_listen_fd, LOCAL_EVENT(LOCAL_EVENT_LISTEN, 0));
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, local_transport_thread, args) != 0) {
+        perror("创建本地传输线程失败");
+        close(local_epoll_fd);
+        close(local_listen_fd);
+        return -1;
+    }
+    pthread_detach(thread);
+    printf("本地传输已启动：%s\n", args->path);
+    return 0;
+}
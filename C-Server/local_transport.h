@@ -0,0 +1,29 @@
+#ifndef LOCAL_TRANSPORT_H
+#define LOCAL_TRANSPORT_H
+
+#include <pthread.h>
+
+#include "frame_ring.h"
+#include "safety.h"
+#include "command.h"
+
+#define LOCAL_MAX_CLIENTS 16           // 同时连接的本地客户端上限
+#define LOCAL_DRAIN_BATCH 256          // 每个共享内存队列每轮最多处理的指令数
+#define LOCAL_FRAME_HEADROOM 32        // 帧队列剩余空间少于此值时暂停处理，指令留在共享内存队列中
+#define LOCAL_BACKOFF_MS 1             // 暂停处理后重新检查帧队列的间隔
+
+// 本地传输线程参数
+typedef struct {
+    const char *path;                        // Unix域socket路径
+    frame_ring_t *ring;
+    safety_table_t *safety;
+    pthread_mutex_t *dispatch_lock;          // 与网络后端共用，保证帧队列只有一个生产者在写
+    void (*quit)(reply_buffer_t *reply);     // 本地客户端发送quit时调用，等已入队的帧写完后退出程序
+    atomic_int *quitting;                    // 非0表示中转程序正在退出，不再处理新指令
+} local_transport_args_t;
+
+// 监听本地Unix域socket并启动本地传输线程：
+// 普通连接与TCP客户端使用相同的协议和回复；发送LOCAL_SHM_HELLO的连接改用共享内存队列，没有回复
+int local_transport_start(local_transport_args_t *args);
+
+#endif // LOCAL_TRANSPORT_H
@@ -3,220 +3,87 @@
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
-#include <fcntl.h>
-#include <termios.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+
+#include "frame_ring.h"
+#include "safety.h"
+#include "serial.h"
+#include "command.h"
+#include "uring.h"
+#include "shm_ring.h"
+#include "local_transport.h"
 
 #define PORT 6657
 #define SERIAL_PORT "/dev/ttyUSB0"  // 串口设备地址
-
-// 打开串口
-int open_serial_port(const char *port) {
-    int fd = open(port, O_RDWR | O_NOCTTY | O_NDELAY);
-    if (fd == -1) {
-        perror("无法打开串口");
-        exit(1);
-    }
-    return fd;
-}
-
-// 配置串口
-void configure_serial_port(int fd) {
-    struct termios options;
-    tcgetattr(fd, &options);
-
-    // 设置波特率
-    cfsetispeed(&options, B115200);  // 接收波特率
-    cfsetospeed(&options, B115200);  // 发送波特率
-
-    // 设置数据位、停止位、无校验
-    options.c_cflag &= ~PARENB;      // 无校验
-    options.c_cflag &= ~CSTOPB;      // 1个停止位
-    options.c_cflag &= ~CSIZE;       // 清除数据位大小
-    options.c_cflag |= CS8;          // 8个数据位
-
-    options.c_cflag |= CLOCAL | CREAD; // 启动接收器
-
-    // 禁用软件流控
-    options.c_iflag &= ~(IXON | IXOFF | IXANY);
-
-    // 设置串口选项
-    tcsetattr(fd, TCSANOW, &options);
-}
-
-// 向STM32发送指令
-void send_to_stm32(int serial_fd, const unsigned char *buffer, ssize_t len) {
-    if (write(serial_fd, buffer, len) != len) {
-        perror("写入串口失败");
-    }
-}
-
-// 从STM32接收数据
-ssize_t read_from_stm32(int serial_fd, unsigned char *buffer, size_t size) {
-    return read(serial_fd, buffer, size);
-}
-
-// 向客户端发送响应
-void send_response(int client_fd, const char *message) {
-    ssize_t len = strlen(message);
-    if (write(client_fd, message, len) != len) {
-        perror("发送响应失败");
-    }
-}
-
-// 原有指令数组（用于处理0xBB协议转化）
-void Reset(int fd) {
-    unsigned char BUF[6][3] = 
-    {
-        {0xaa,0x00,0x5A},
-        {0xaa,0x01,0x5A},
-        {0xaa,0x02,0x5A},
-        {0xaa,0x03,0x5A},        
-        {0xaa,0x04,0x5A},
-        {0xaa,0x05,0x5A},
-    };
-    for(int i = 0;i < 4;i++) {
-        write(fd,BUF[i],3);
-        usleep(500000);
+#define URING_ENTRIES 16               // io_uring提交队列长度
+#define CLIENT_PAUSE_OCCUPANCY (FRAME_RING_SIZE / 2)  // 单线程后端：帧队列超过此值时暂停读取客户端，限制排队延迟
+
+static frame_ring_t frame_ring;
+static safety_table_t safety_table;
+static pthread_mutex_t dispatch_lock = PTHREAD_MUTEX_INITIALIZER;  // 网络后端与本地传输线程轮流写帧队列
+static int relay_serial_fd = -1;
+static int relay_server_fd = -1;
+static atomic_int relay_quitting;            // 已收到quit：不再接收新指令，等已入队的帧写完后退出
+static _Atomic size_t relay_quit_head;       // 收到quit时帧队列的写入位置
+static pthread_mutex_t quit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// 收到quit指令：记下此前入队的帧，之后各后端不再读取客户端
+void begin_quit(void) {
+    if (atomic_load(&relay_quitting)) {
+        return;
     }
+    atomic_store(&relay_quit_head, atomic_load(&frame_ring.head));
+    atomic_store(&relay_quitting, 1);
+    printf("收到quit指令，等待已入队的 %zu 帧写入串口...\n", ring_occupancy(&frame_ring));
 }
 
-void Down(int fd) {
-    unsigned char BUF[3][3] = 
-    {
-        {0xaa,0x01,0x78},
-        {0xaa,0x02,0x3F},
-        {0xaa,0x03,0x48},
-    };
-    for(int i = 0;i < 3;i++) {
-        write(fd,BUF[i],3);
-        usleep(500000);
-    }
+// 收到quit之前入队的帧是否都已写入串口（或写入出错）
+int quit_drained(void) {
+    return atomic_load(&frame_ring.frames_written) + atomic_load(&frame_ring.frames_failed) >=
+           atomic_load(&relay_quit_head);
 }
 
-void Up(int fd) {
-    unsigned char BUF[3][3] = 
-    {
-        {0xaa,0x03,0x5A},
-        {0xaa,0x02,0x5A},
-        {0xaa,0x01,0x5A},
-    };
-    for(int i = 0;i < 3;i++) {
-        write(fd,BUF[i],3);
-        usleep(500000);
+// 收到quit指令：等已回复过的指令全部写入串口，再打印统计信息并退出
+// 串口由其他线程写出时在这里等待；单线程后端要先在自己的循环中写完，再调用这里
+// reply为NULL表示发送quit的客户端已经断开
+void quit_relay(reply_buffer_t *reply, int serial_fd, int server_fd) {
+    pthread_mutex_lock(&quit_lock);  // 只有一个线程执行退出，其余线程停在这里直到进程结束
+    begin_quit();
+    ring_wake_consumer(&frame_ring);  // quit之前入队的帧可能还没唤醒串口线程
+    while (!quit_drained()) {
+        usleep(1000);
     }
-}
 
-void Scrach(int fd) {
-    unsigned char BUF[2][3] = 
-    {
-        {0xaa,0x04,0x3c},    // 夹子张开
-        {0xaa,0x04,0x82},    // 夹子夹紧
-    };
-    for(int i = 0;i < 2;i++) {
-        write(fd,BUF[i],3);
-        usleep(500000);
-    }
-}
-
-void Push(int fd) {
-    unsigned char BUF[1][3] = 
-    {
-        {0xaa,0x04,0x3c},    // 夹子张开
-    };
-    for(int i = 0;i < 1;i++) {
-        write(fd,BUF[i],3);
-        usleep(500000);
+    char stats[256];
+    char rejects[768];
+    format_ring_stats(&frame_ring, stats, sizeof(stats));
+    format_safety_stats(&safety_table, rejects, sizeof(rejects));
+    printf("关闭程序...\n%s\n%s\n", stats, rejects);
+    if (reply != NULL) {
+        send_response(reply, "中转程序已关闭");
+        flush_responses(reply);
+        close(reply->fd);
     }
+    close(serial_fd);
+    close(server_fd);
+    exit(0);  // 直接退出程序
 }
 
-// 处理接收到的指令（支持0xBB协议和0xAA协议）
-void process_command(int client_fd, int serial_fd, const unsigned char *buffer, ssize_t len) {
-    if (len < 2) {
-        printf("指令数据不完整\n");
-        return;
-    }
-
-    // 处理特殊字符串指令
-    if (strncmp((char *)buffer, "TEST", 4) == 0) {
-        printf("收到TEST指令，回复测试成功\n");
-        send_response(client_fd, "TEST指令已收到，连接正常");
-        return;
-    }
-
-    // 处理0xAA协议
-    if (buffer[0] == 0xAA) {
-        unsigned char axis = buffer[1];
-        unsigned char angle = buffer[2];
-        
-        // 打印指令内容
-        printf("收到控制面板指令（0xAA协议）：\n");
-        printf("包头: 0xAA\n");
-        printf("轴编号: %d\n", axis + 1);
-        printf("角度: %d°\n", angle);
-
-        // 向STM32发送控制命令
-        unsigned char stm32_command[3] = {0xAA, axis, angle};
-        send_to_stm32(serial_fd, stm32_command, sizeof(stm32_command));
-
-        // 向客户端发送确认消息
-        char response[256];
-        snprintf(response, sizeof(response), "指令已收到：轴 %d 的角度设置为 %d°", axis + 1, angle);
-        send_response(client_fd, response);
-        return;
-    }
-
-    // 处理0xBB协议
-    else if (buffer[0] == 0xBB) {
-        unsigned char command_type = buffer[1];
-        
-        // 根据不同的command_type调用对应的动作
-        switch (command_type) {
-            case 0x00:  // 全部角度为5A
-                Reset(serial_fd);
-                break;
-            case 0x01:  // 左转
-                Down(serial_fd);
-                break;
-            case 0x02:  // 右转
-                Up(serial_fd);
-                break;
-            case 0x03:  // 抓
-                Scrach(serial_fd);
-                break;
-            case 0x04:  // 放
-                Push(serial_fd);
-                break;
-            default:
-                printf("未知的命令类型 0x%02X\n", command_type);
-                return;
-        }
-
-        // 向客户端发送响应
-        send_response(client_fd, "0xBB命令已执行\n");
-        return;
-    }
-
-    // 处理无效包头
-    else {
-        printf("无效的包头\n");
-        send_response(client_fd, "无效的指令包头");
-        return;
-    }
+// 本地客户端发送quit（或网络后端已收到quit时本地传输线程停止处理，reply为NULL）
+void quit_relay_local(reply_buffer_t *reply) {
+    quit_relay(reply, relay_serial_fd, relay_server_fd);
 }
 
-
-// 监听并接收控制面板指令
-void listen_and_debug() {
-    int server_fd, client_fd;
-    struct sockaddr_in server_addr, client_addr;
-    socklen_t addr_len = sizeof(client_addr);
-    char buffer[1024];
-    ssize_t len;
-
-    // 打开并配置串口
-    int serial_fd = open_serial_port(SERIAL_PORT);
-    configure_serial_port(serial_fd);
+// 创建并监听TCP socket
+int create_server_socket(void) {
+    int server_fd;
+    struct sockaddr_in server_addr;
 
     // 创建TCP socket
     if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
@@ -232,6 +99,7 @@ void listen_and_debug() {
         exit(1);
     }
 
+    memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY; // 监听所有可用的网络接口
     server_addr.sin_port = htons(PORT);
@@ -249,33 +117,75 @@ void listen_and_debug() {
         close(server_fd);
         exit(1);
     }
+    return server_fd;
+}
 
-    printf("网络调试程序已启动，监听端口 %d...\n", PORT);
+// 接受客户端连接
+int accept_client(int server_fd, client_conn_t *conn, reply_buffer_t *reply) {
+    struct sockaddr_in client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+    int client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &addr_len);
+    if (client_fd == -1) {
+        perror("接受连接失败");
+        return -1;
+    }
+    printf("客户端已连接\n");
+    conn->fd = client_fd;
+    conn->pending = 0;
+    conn->stalled = 0;
+    reply->fd = client_fd;
+    reply->len = 0;
+    reply->off = 0;
+    return client_fd;
+}
+
+// 阻塞后端：网络线程阻塞读取客户端，串口线程负责写串口
+void run_blocking_backend(int server_fd, int serial_fd, int net_cpu, int serial_cpu) {
+    static client_conn_t conn;
+    static reply_buffer_t reply;
+    ssize_t len;
+
+    // 启动串口线程
+    static serial_writer_args_t writer_args;
+    writer_args.ring = &frame_ring;
+    writer_args.serial_fd = serial_fd;
+    writer_args.cpu = serial_cpu;
+    pthread_t writer;
+    if (pthread_create(&writer, NULL, serial_writer_thread, &writer_args) != 0) {
+        perror("创建串口线程失败");
+        exit(1);
+    }
+    pin_thread_to_cpu(net_cpu, "网络线程");
+    conn.throttle = 1;
 
     while (1) {
         // 接受客户端连接
-        if ((client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &addr_len)) == -1) {
-            perror("接受连接失败");
+        if (accept_client(server_fd, &conn, &reply) == -1) {
             continue;
         }
-        printf("客户端已连接\n");
 
         // 读取客户端数据
-        while ((len = read(client_fd, buffer, sizeof(buffer))) > 0) {
-            buffer[len] = '\0';  // 确保字符串结束
-
-            // 修改quit检测逻辑
-        if (len == 4 && strncmp((char *)buffer, "quit", 4) == 0) {
-            printf("收到quit指令，关闭程序...\n");
-            send_response(client_fd, "中转程序已关闭");
-            close(client_fd);
-            close(serial_fd);
-            close(server_fd);
-            exit(0);  // 直接退出程序
+        while ((len = read(conn.fd, conn.buffer + conn.pending, sizeof(conn.buffer) - conn.pending)) > 0) {
+            if (atomic_load(&relay_quitting)) {
+                quit_relay(&reply, serial_fd, server_fd);  // 本地客户端已发送quit，不再接收新指令
             }
-
-            // 处理并打印接收到的角度控制指令
-            process_command(client_fd, serial_fd, (unsigned char *)buffer, len);
+            do {
+                // 帧队列放不下剩余的指令时等串口线程消费后继续分发，期间不读取客户端，由TCP把压力传回客户端
+                while (conn.stalled && !dispatch_has_room(&frame_ring)) {
+                    usleep(RING_PUSH_RETRY_US);
+                }
+                pthread_mutex_lock(&dispatch_lock);
+                int quit = handle_client_data(&conn, &reply, &frame_ring, &safety_table, len);
+                pthread_mutex_unlock(&dispatch_lock);
+                if (quit) {
+                    quit_relay(&reply, serial_fd, server_fd);
+                }
+                len = 0;
+
+                // 本次分发的指令全部入队后再统一唤醒串口线程，回复也一次发出
+                ring_wake_consumer(&frame_ring);
+                flush_responses(&reply);
+            } while (conn.stalled);
         }
 
         if (len == 0) {
@@ -285,7 +195,467 @@ void listen_and_debug() {
         }
 
         // 关闭客户端连接
-        close(client_fd);
+        close(conn.fd);
+    }
+}
+
+// 修改epoll监听的事件
+void epoll_update(int epoll_fd, int op, int fd, uint32_t events) {
+    struct epoll_event ev = { .events = events, .data = { .fd = fd } };
+    if (epoll_ctl(epoll_fd, op, fd, &ev) == -1) {
+        perror("epoll_ctl失败");
+    }
+}
+
+// epoll后端：关闭客户端连接，重新开始接受连接（正在退出时不再接受）
+void epoll_close_client(int epoll_fd, int server_fd, int *client_fd) {
+    epoll_update(epoll_fd, EPOLL_CTL_DEL, *client_fd, 0);
+    close(*client_fd);
+    *client_fd = -1;
+    if (!atomic_load(&relay_quitting)) {
+        epoll_update(epoll_fd, EPOLL_CTL_ADD, server_fd, EPOLLIN);
+    }
+}
+
+// epoll后端：单线程处理客户端和串口，串口或客户端不可写时等待EPOLLOUT，不会阻塞循环
+void run_epoll_backend(int server_fd, int serial_fd, int net_cpu) {
+    static client_conn_t conn;
+    static reply_buffer_t reply;
+    static serial_pump_t pump;
+    int client_fd = -1;
+    int serial_blocked = 0;
+    uint32_t client_events = 0;              // 当前为客户端监听的事件
+
+    pin_thread_to_cpu(net_cpu, "网络线程");
+    conn.throttle = 1;
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1) {
+        perror("创建epoll失败");
+        exit(1);
+    }
+    epoll_update(epoll_fd, EPOLL_CTL_ADD, server_fd, EPOLLIN);
+    epoll_update(epoll_fd, EPOLL_CTL_ADD, serial_fd, 0);
+    epoll_update(epoll_fd, EPOLL_CTL_ADD, frame_ring.wake_fd, EPOLLIN);  // 本地传输线程入队后唤醒
+
+    while (1) {
+        // 串口可写时尽量把队列中到期的帧一次写出
+        uint64_t now = monotonic_ns();
+        while (!serial_blocked && serial_pump_fill(&pump, &frame_ring, now)) {
+            ssize_t n = write(serial_fd, pump.data + pump.off, pump.len - pump.off);
+            if (n > 0) {
+                serial_pump_written(&pump, &frame_ring, n, now);
+            } else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                atomic_fetch_add_explicit(&frame_ring.write_stalls, 1, memory_order_relaxed);
+                serial_blocked = 1;
+                epoll_update(epoll_fd, EPOLL_CTL_MOD, serial_fd, EPOLLOUT);
+            } else if (n == -1 && errno != EINTR) {
+                perror("写入串口失败");
+                atomic_fetch_add_explicit(&frame_ring.frames_failed, pump.frames, memory_order_relaxed);
+                pump.len = pump.off = 0;
+            }
+        }
+
+        // 收到quit后，已入队的帧全部写出再退出
+        int quitting = atomic_load(&relay_quitting);
+        if (quitting && quit_drained()) {
+            quit_relay(client_fd != -1 ? &reply : NULL, serial_fd, server_fd);
+        }
+
+        // 分发因帧队列空间不足暂停时，串口腾出空间后继续处理剩余的指令
+        if (client_fd != -1 && !quitting && conn.stalled && reply.len == 0 && dispatch_has_room(&frame_ring)) {
+            pthread_mutex_lock(&dispatch_lock);
+            int quit = handle_client_data(&conn, &reply, &frame_ring, &safety_table, 0);
+            pthread_mutex_unlock(&dispatch_lock);
+            if (quit) {
+                begin_quit();
+            }
+            if (flush_responses_nonblock(&reply) == -1) {
+                epoll_close_client(epoll_fd, server_fd, &client_fd);
+            }
+            continue;         // 回到循环开头把新入队的帧写出串口
+        }
+
+        // 回复没发完时只等待客户端可写，发完之前不读取新指令；
+        // 串口跟不上时暂停读取客户端，由TCP把压力传回客户端，而不是丢弃帧
+        if (client_fd != -1) {
+            uint32_t want = EPOLLIN;
+            if (reply.off < reply.len) {
+                want = EPOLLOUT;
+            } else if (quitting || conn.stalled || ring_occupancy(&frame_ring) >= CLIENT_PAUSE_OCCUPANCY) {
+                want = 0;
+            }
+            if (want != client_events) {
+                client_events = want;
+                epoll_update(epoll_fd, EPOLL_CTL_MOD, client_fd, want);
+            }
+        }
+
+        // 先声明在等待再检查队列，本地传输线程入队后一定会唤醒epoll
+        atomic_store_explicit(&frame_ring.consumer_waiting, 1, memory_order_seq_cst);
+
+        // 宏动作等待节拍时，按下一批的时间设置超时；
+        // 上面填充时队列为空、之后本地传输线程才入队的帧可能已经到期，此时不等待
+        int timeout = -1;
+        if (!serial_blocked && ring_occupancy(&frame_ring) > 0) {
+            timeout = pump.next_due_ns > now ? (int)((pump.next_due_ns - now + 999999) / 1000000) : 0;
+        }
+
+        struct epoll_event events[4];
+        int count = epoll_wait(epoll_fd, events, 4, timeout);
+        atomic_store_explicit(&frame_ring.consumer_waiting, 0, memory_order_relaxed);
+        if (count == -1) {
+            if (errno != EINTR) {
+                perror("epoll_wait失败");
+            }
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == serial_fd) {
+                serial_blocked = 0;
+                epoll_update(epoll_fd, EPOLL_CTL_MOD, serial_fd, 0);
+            } else if (fd == frame_ring.wake_fd) {
+                uint64_t value;
+                if (read(frame_ring.wake_fd, &value, sizeof(value)) == -1) {
+                    perror("读取唤醒事件失败");
+                }
+            } else if (fd == server_fd) {
+                // 同一时间只服务一个客户端，其余连接留在backlog中
+                client_fd = accept_client(server_fd, &conn, &reply);
+                if (client_fd != -1) {
+                    // 客户端不及时读取回复时，写回复不能阻塞串口的发送
+                    fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+                    client_events = EPOLLIN;
+                    epoll_update(epoll_fd, EPOLL_CTL_DEL, server_fd, 0);
+                    epoll_update(epoll_fd, EPOLL_CTL_ADD, client_fd, EPOLLIN);
+                }
+            } else if (fd == client_fd && (events[i].events & EPOLLOUT)) {
+                // 继续发送上次没发完的回复
+                if (flush_responses_nonblock(&reply) == -1) {
+                    epoll_close_client(epoll_fd, server_fd, &client_fd);
+                }
+            } else if (fd == client_fd) {
+                ssize_t len = read(client_fd, conn.buffer + conn.pending, sizeof(conn.buffer) - conn.pending);
+                if (len == -1 && (errno == EAGAIN || errno == EINTR)) {
+                    continue;
+                }
+                if (len > 0) {
+                    pthread_mutex_lock(&dispatch_lock);
+                    int quit = handle_client_data(&conn, &reply, &frame_ring, &safety_table, len);
+                    pthread_mutex_unlock(&dispatch_lock);
+                    if (quit) {
+                        begin_quit();
+                    }
+                    // 发不完的部分留在缓冲区，下一轮等待EPOLLOUT
+                    if (flush_responses_nonblock(&reply) == -1) {
+                        epoll_close_client(epoll_fd, server_fd, &client_fd);
+                    }
+                    continue;
+                }
+                if (len == 0) {
+                    printf("客户端已断开连接\n");
+                } else {
+                    perror("读取数据失败");
+                }
+                epoll_close_client(epoll_fd, server_fd, &client_fd);
+            }
+        }
+    }
+}
+
+// 启动本地传输线程（帧队列初始化之后调用），失败时只打印错误，不影响TCP客户端
+void start_local_transport(const char *local_path) {
+    static local_transport_args_t local_args;
+    local_args.path = local_path;
+    local_args.ring = &frame_ring;
+    local_args.safety = &safety_table;
+    local_args.dispatch_lock = &dispatch_lock;
+    local_args.quit = quit_relay_local;
+    local_args.quitting = &relay_quitting;
+    local_transport_start(&local_args);
+}
+
+#ifdef RELAY_HAVE_URING
+
+// io_uring操作标识（放在user_data中）
+enum {
+    URING_ACCEPT_POLL = 1,                   // 等待新连接
+    URING_RECV,                              // 读取客户端数据
+    URING_ACK,                               // 发送回复
+    URING_SERIAL,                            // 写串口
+    URING_SERIAL_POLL,                       // 等待串口可写
+    URING_TIMER,                             // 宏动作节拍
+    URING_WAKE_POLL,                         // 本地传输线程入队后唤醒
+};
+
+// 注册缓冲区编号
+enum {
+    URING_BUF_RECV = 0,
+    URING_BUF_REPLY0,
+    URING_BUF_REPLY1,
+    URING_BUF_SERIAL,
+};
+
+
+// io_uring后端：单线程，接收、回复和串口写入在同一次提交中批量完成
+// 只在注册缓冲区失败时返回（例如超出RLIMIT_MEMLOCK），此时还没有初始化帧队列和启动本地传输，调用方改用epoll
+void run_uring_backend(uring_t *ring, int server_fd, int serial_fd, int net_cpu, const char *local_path) {
+    static client_conn_t conn;
+    static reply_buffer_t replies[2];        // 一个正在发送时另一个接收新的回复
+    static serial_pump_t pump;
+    int client_fd = -1;
+    int active = 0;                          // 正在接收回复的缓冲区
+    int ack_buf = -1;                        // 正在发送（或部分发送）的缓冲区
+    unsigned conn_gen = 0, ack_gen = 0;      // 连接编号，丢弃已断开连接的回复
+    int accept_inflight = 0, recv_inflight = 0, ack_inflight = 0;
+    int serial_inflight = 0, timer_inflight = 0, wake_inflight = 0;
+    struct __kernel_timespec timer_ts;
+
+    pin_thread_to_cpu(net_cpu, "网络线程");
+    conn.throttle = 1;
+
+    struct iovec iovs[4] = {
+        [URING_BUF_RECV] = { conn.buffer, sizeof(conn.buffer) },
+        [URING_BUF_REPLY0] = { replies[0].data, sizeof(replies[0].data) },
+        [URING_BUF_REPLY1] = { replies[1].data, sizeof(replies[1].data) },
+        [URING_BUF_SERIAL] = { pump.data, sizeof(pump.data) },
+    };
+    if (uring_register_buffers(ring, iovs, 4) == -1) {
+        perror("注册io_uring缓冲区失败");
+        return;
+    }
+    ring_init(&frame_ring, 0);
+    start_local_transport(local_path);
+    printf("网络调试程序已启动（io_uring），监听端口 %d...\n", PORT);
+
+    while (1) {
+        uint64_t now = monotonic_ns();
+
+        // 收到quit后，已入队的帧全部写出、回复也不在发送中时再退出
+        int quitting = atomic_load(&relay_quitting);
+        if (quitting && quit_drained() && !ack_inflight) {
+            if (ack_buf != -1) {
+                flush_responses(&replies[ack_buf]);
+            }
+            quit_relay(client_fd != -1 ? &replies[active] : NULL, serial_fd, server_fd);
+        }
+
+        // 没有客户端时等待新连接
+        if (client_fd == -1 && !accept_inflight && !quitting) {
+            uring_prep_poll(ring, URING_ACCEPT_POLL, server_fd, POLLIN);
+            accept_inflight = 1;
+        }
+
+        // 分发因帧队列空间不足暂停时，串口腾出空间后继续处理剩余的指令
+        if (client_fd != -1 && !quitting && conn.stalled && replies[active].len == 0 && dispatch_has_room(&frame_ring)) {
+            pthread_mutex_lock(&dispatch_lock);
+            int quit = handle_client_data(&conn, &replies[active], &frame_ring, &safety_table, 0);
+            pthread_mutex_unlock(&dispatch_lock);
+            if (quit) {
+                begin_quit();
+            }
+        }
+
+        // 发送缓冲的回复；正在发送时新回复留在另一个缓冲区
+        if (client_fd != -1 && !ack_inflight) {
+            if (ack_buf == -1 && replies[active].len > 0) {
+                ack_buf = active;
+                active ^= 1;
+            }
+            if (ack_buf != -1) {
+                reply_buffer_t *reply = &replies[ack_buf];
+                uring_prep_rw_fixed(ring, IORING_OP_WRITE_FIXED, URING_ACK, client_fd, reply->data + reply->off,
+                                    (unsigned)(reply->len - reply->off), URING_BUF_REPLY0 + ack_buf);
+                ack_inflight = 1;
+                ack_gen = conn_gen;
+            }
+        }
+
+        // 写串口；宏动作未到节拍时设置定时器
+        if (!serial_inflight) {
+            if (serial_pump_fill(&pump, &frame_ring, now)) {
+                uring_prep_rw_fixed(ring, IORING_OP_WRITE_FIXED, URING_SERIAL, serial_fd, pump.data + pump.off,
+                                    (unsigned)(pump.len - pump.off), URING_BUF_SERIAL);
+                serial_inflight = 1;
+            } else if (!timer_inflight && ring_occupancy(&frame_ring) > 0) {
+                // 填充后本地传输线程才入队的帧可能已经到期，定时器立即触发
+                uint64_t wait_ns = pump.next_due_ns > now ? pump.next_due_ns - now : 0;
+                timer_ts.tv_sec = (long long)(wait_ns / 1000000000ull);
+                timer_ts.tv_nsec = (long long)(wait_ns % 1000000000ull);
+                uring_prep_timeout(ring, URING_TIMER, &timer_ts);
+                timer_inflight = 1;
+            }
+        }
+
+        // 等待本地传输线程的唤醒；先声明在等待再检查队列
+        if (!wake_inflight) {
+            uring_prep_poll(ring, URING_WAKE_POLL, frame_ring.wake_fd, POLLIN);
+            wake_inflight = 1;
+        }
+        atomic_store_explicit(&frame_ring.consumer_waiting, 1, memory_order_seq_cst);
+        if (!serial_inflight && !timer_inflight && ring_occupancy(&frame_ring) > 0) {
+            atomic_store_explicit(&frame_ring.consumer_waiting, 0, memory_order_relaxed);
+            continue;
+        }
+
+        // 继续读取客户端；上一批回复还没发出时先不读，保证回复缓冲区不会溢出
+        // 分发暂停或帧队列超过一半时也先不读，串口写完成后会再回到这里
+        if (client_fd != -1 && !recv_inflight && replies[active].len == 0 && !conn.stalled && !quitting &&
+            ring_occupancy(&frame_ring) < CLIENT_PAUSE_OCCUPANCY) {
+            uring_prep_rw_fixed(ring, IORING_OP_READ_FIXED, URING_RECV, client_fd, conn.buffer + conn.pending,
+                                (unsigned)(sizeof(conn.buffer) - conn.pending), URING_BUF_RECV);
+            recv_inflight = 1;
+        }
+
+        if (uring_submit_and_wait(ring) == -1) {
+            perror("io_uring提交失败");
+            exit(1);
+        }
+        atomic_store_explicit(&frame_ring.consumer_waiting, 0, memory_order_relaxed);
+
+        // 处理所有完成事件
+        unsigned head = *ring->cq_head;
+        unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+        now = monotonic_ns();
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+            int res = cqe->res;
+            switch (cqe->user_data) {
+                case URING_ACCEPT_POLL:
+                    accept_inflight = 0;
+                    if (res > 0) {
+                        client_fd = accept_client(server_fd, &conn, &replies[active]);
+                        replies[active ^ 1].fd = client_fd;
+                    }
+                    break;
+                case URING_RECV:
+                    recv_inflight = 0;
+                    if (client_fd == -1) {
+                        break;
+                    }
+                    if (res > 0) {
+                        pthread_mutex_lock(&dispatch_lock);
+                        int quit = handle_client_data(&conn, &replies[active], &frame_ring, &safety_table, res);
+                        pthread_mutex_unlock(&dispatch_lock);
+                        if (quit) {
+                            begin_quit();
+                        }
+                        break;
+                    }
+                    if (res == 0) {
+                        printf("客户端已断开连接\n");
+                    } else {
+                        errno = -res;
+                        perror("读取数据失败");
+                    }
+                    close(client_fd);
+                    client_fd = -1;
+                    conn_gen++;
+                    replies[active].len = 0;
+                    if (!ack_inflight && ack_buf != -1) {
+                        replies[ack_buf].len = replies[ack_buf].off = 0;
+                        ack_buf = -1;
+                    }
+                    break;
+                case URING_ACK:
+                    ack_inflight = 0;
+                    if (res < 0 || ack_gen != conn_gen) {
+                        if (res < 0 && ack_gen == conn_gen) {
+                            errno = -res;
+                            perror("发送响应失败");
+                        }
+                        replies[ack_buf].len = replies[ack_buf].off = 0;
+                        ack_buf = -1;
+                        break;
+                    }
+                    replies[ack_buf].off += res;
+                    if (replies[ack_buf].off >= replies[ack_buf].len) {
+                        replies[ack_buf].len = replies[ack_buf].off = 0;
+                        ack_buf = -1;
+                    }
+                    break;
+                case URING_SERIAL:
+                    serial_inflight = 0;
+                    if (res == -EAGAIN) {
+                        atomic_fetch_add_explicit(&frame_ring.write_stalls, 1, memory_order_relaxed);
+                        uring_prep_poll(ring, URING_SERIAL_POLL, serial_fd, POLLOUT);
+                        serial_inflight = 1;
+                    } else if (res < 0) {
+                        errno = -res;
+                        perror("写入串口失败");
+                        atomic_fetch_add_explicit(&frame_ring.frames_failed, pump.frames, memory_order_relaxed);
+                        pump.len = pump.off = 0;
+                    } else {
+                        serial_pump_written(&pump, &frame_ring, res, now);
+                    }
+                    break;
+                case URING_SERIAL_POLL:
+                    serial_inflight = 0;
+                    break;
+                case URING_TIMER:
+                    timer_inflight = 0;
+                    break;
+                case URING_WAKE_POLL:
+                    wake_inflight = 0;
+                    if (res > 0) {
+                        uint64_t value;
+                        if (read(frame_ring.wake_fd, &value, sizeof(value)) == -1) {
+                            perror("读取唤醒事件失败");
+                        }
+                    }
+                    break;
+            }
+        }
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+#endif
+
+// 启动中转程序，backend为 uring / epoll / blocking
+void listen_and_debug(const char *backend, int net_cpu, int serial_cpu, const char *limits_path,
+                      const char *local_path) {
+    // 加载限位配置；没有用-c指定时使用程序所在目录下的配置
+    load_safety_config(&safety_table, limits_path);
+
+    // 打开并配置串口
+    int serial_fd = open_serial_port(SERIAL_PORT);
+    configure_serial_port(serial_fd);
+
+    int server_fd = create_server_socket();
+    relay_serial_fd = serial_fd;
+    relay_server_fd = server_fd;
+
+#ifdef RELAY_HAVE_URING
+    static uring_t uring;
+    if (strcmp(backend, "uring") == 0) {
+        if (uring_init(&uring, URING_ENTRIES) == 0) {
+            run_uring_backend(&uring, server_fd, serial_fd, net_cpu, local_path);
+            close(uring.fd);
+        } else {
+            perror("初始化io_uring失败");
+        }
+        printf("改用epoll\n");
+        backend = "epoll";
+    }
+#else
+    if (strcmp(backend, "uring") == 0) {
+        printf("未编译io_uring支持，改用epoll\n");
+        backend = "epoll";
+    }
+#endif
+
+    if (strcmp(backend, "epoll") == 0) {
+        ring_init(&frame_ring, 0);
+        start_local_transport(local_path);
+        printf("网络调试程序已启动（epoll），监听端口 %d...\n", PORT);
+        run_epoll_backend(server_fd, serial_fd, net_cpu);
+    } else {
+        ring_init(&frame_ring, RING_PUSH_TIMEOUT_US);
+        start_local_transport(local_path);
+        printf("网络调试程序已启动（阻塞+串口线程），监听端口 %d...\n", PORT);
+        run_blocking_backend(server_fd, serial_fd, net_cpu, serial_cpu);
     }
 
     // 关闭服务器socket
@@ -293,7 +663,44 @@ void listen_and_debug() {
     close(serial_fd);
 }
 
-int main() {
-    listen_and_debug();
+// 用法: main [-b uring|epoll|blocking] [-n 网络线程CPU] [-s 串口线程CPU] [-c 限位配置文件] [-l 本地socket路径] [-q]
+int main(int argc, char *argv[]) {
+    const char *backend = "uring";
+    int net_cpu = -1;
+    int serial_cpu = -1;
+    const char *limits_path = NULL;           // NULL表示使用程序所在目录下的默认配置
+    const char *local_path = LOCAL_SOCKET_PATH;
+    int opt;
+    while ((opt = getopt(argc, argv, "b:n:s:c:l:q")) != -1) {
+        switch (opt) {
+            case 'b':
+                backend = optarg;
+                break;
+            case 'n':
+                net_cpu = atoi(optarg);
+                break;
+            case 's':
+                serial_cpu = atoi(optarg);
+                break;
+            case 'c':
+                limits_path = optarg;
+                break;
+            case 'l':
+                local_path = optarg;
+                break;
+            case 'q':
+                command_verbose = 0;  // 高频本地指令时不逐条打印
+                break;
+            default:
+                fprintf(stderr, "用法: %s [-b uring|epoll|blocking] [-n 网络线程CPU] [-s 串口线程CPU] [-c 限位配置文件] [-l 本地socket路径] [-q]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (strcmp(backend, "uring") != 0 && strcmp(backend, "epoll") != 0 && strcmp(backend, "blocking") != 0) {
+        fprintf(stderr, "未知的后端 %s\n", backend);
+        return 1;
+    }
+
+    listen_and_debug(backend, net_cpu, serial_cpu, limits_path, local_path);
     return 0;
 }
@@ -0,0 +1,212 @@
+#include "safety.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+
+// 设置某个轴的限位范围
+void safety_set_limit(safety_table_t *safety, int axis, int min, int max) {
+    memset(safety->angle_ok[axis], 0, sizeof(safety->angle_ok[axis]));
+    for (int angle = min; angle <= max; angle++) {
+        safety->angle_ok[axis][angle >> 5] |= 1u << (angle & 31);
+    }
+    safety->limit_min[axis] = (unsigned char)min;
+    safety->limit_max[axis] = (unsigned char)max;
+}
+
+// 解析禁止区定义：zone <名称> <轴号>:<最小>-<最大> ...
+int safety_add_zone(safety_table_t *safety, char *spec, int line_no) {
+    if (safety->zone_count >= MAX_ZONES) {
+        fprintf(stderr, "限位配置第 %d 行：禁止区数量超过 %d 个\n", line_no, MAX_ZONES);
+        return -1;
+    }
+    char *name = strtok(spec, " \t\r\n");
+    if (name == NULL) {
+        fprintf(stderr, "限位配置第 %d 行：缺少禁止区名称\n", line_no);
+        return -1;
+    }
+
+    int zone = safety->zone_count;
+    uint32_t bit = 1u << zone;
+    int constrained[AXIS_COUNT] = {0};
+    int ranges = 0;
+    char *cond;
+    while ((cond = strtok(NULL, " \t\r\n")) != NULL) {
+        int axis, min, max;
+        if (sscanf(cond, "%d:%d-%d", &axis, &min, &max) != 3 ||
+            axis < 1 || axis > AXIS_COUNT || min < 0 || max > 255 || min > max) {
+            fprintf(stderr, "限位配置第 %d 行：无效的禁止区条件 %s\n", line_no, cond);
+            return -1;
+        }
+        // 同一轴多次出现时取并集
+        if (!constrained[axis - 1]) {
+            for (int angle = 0; angle < 256; angle++) {
+                safety->zone_hits[axis - 1][angle] &= ~bit;
+            }
+            constrained[axis - 1] = 1;
+        }
+        for (int angle = min; angle <= max; angle++) {
+            safety->zone_hits[axis - 1][angle] |= bit;
+        }
+        ranges++;
+    }
+    if (ranges == 0) {
+        fprintf(stderr, "限位配置第 %d 行：禁止区 %s 没有条件\n", line_no, name);
+        return -1;
+    }
+
+    snprintf(safety->zone_names[zone], ZONE_NAME_LEN, "%s", name);
+    safety->zone_mask |= bit;
+    safety->zone_count++;
+    return 0;
+}
+
+// 默认限位配置的路径：程序所在目录下的LIMITS_CONFIG，与启动时的工作目录无关
+void default_safety_config_path(char *out, size_t size) {
+    char exe[4096];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (len <= 0) {
+        snprintf(out, size, "%s", LIMITS_CONFIG);
+        return;
+    }
+    exe[len] = '\0';
+    snprintf(out, size, "%s/%s", dirname(exe), LIMITS_CONFIG);
+}
+
+// 加载限位配置，配置有误或初始姿态不合法时退出程序
+// path为NULL时使用默认路径，文件不存在则使用默认限位（全部0~180°，无禁止区）；指定的文件打不开时退出
+void load_safety_config(safety_table_t *safety, const char *path) {
+    char default_path[4096];
+    int required = path != NULL;
+    if (path == NULL) {
+        default_safety_config_path(default_path, sizeof(default_path));
+        path = default_path;
+    }
+    memset(safety, 0, sizeof(*safety));
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        safety_set_limit(safety, axis, 0, 180);
+        safety->pose[axis] = 90;
+        // 不约束该轴的禁止区对任意角度都成立，先全部置位
+        for (int angle = 0; angle < 256; angle++) {
+            safety->zone_hits[axis][angle] = 0xFFFFFFFFu;
+        }
+    }
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        if (required) {
+            perror(path);
+            fprintf(stderr, "无法打开限位配置 %s\n", path);
+            exit(1);
+        }
+        printf("警告：未找到限位配置 %s，使用默认限位 0~180°，没有禁止区\n", path);
+        return;
+    }
+
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        int axis, min, max;
+        int pose[AXIS_COUNT];
+        if (strncmp(p, "axis", 4) == 0) {
+            if (sscanf(p + 4, "%d %d %d", &axis, &min, &max) != 3 ||
+                axis < 1 || axis > AXIS_COUNT || min < 0 || max > 255 || min > max) {
+                fprintf(stderr, "限位配置第 %d 行：无效的轴限位\n", line_no);
+                exit(1);
+            }
+            safety_set_limit(safety, axis - 1, min, max);
+        } else if (strncmp(p, "pose", 4) == 0) {
+            if (sscanf(p + 4, "%d %d %d %d %d %d", &pose[0], &pose[1], &pose[2],
+                       &pose[3], &pose[4], &pose[5]) != AXIS_COUNT) {
+                fprintf(stderr, "限位配置第 %d 行：初始姿态需要 %d 个角度\n", line_no, AXIS_COUNT);
+                exit(1);
+            }
+            for (int i = 0; i < AXIS_COUNT; i++) {
+                if (pose[i] < 0 || pose[i] > 255) {
+                    fprintf(stderr, "限位配置第 %d 行：轴 %d 的初始角度 %d 无效\n", line_no, i + 1, pose[i]);
+                    exit(1);
+                }
+                safety->pose[i] = (unsigned char)pose[i];
+            }
+        } else if (strncmp(p, "zone", 4) == 0) {
+            if (safety_add_zone(safety, p + 4, line_no) != 0) {
+                exit(1);
+            }
+        } else {
+            fprintf(stderr, "限位配置第 %d 行：未知的配置项\n", line_no);
+            exit(1);
+        }
+    }
+    fclose(fp);
+
+    // 禁止区只保留已定义的位
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        for (int angle = 0; angle < 256; angle++) {
+            safety->zone_hits[axis][angle] &= safety->zone_mask;
+        }
+    }
+
+    // 初始姿态本身必须在限位内且不在禁止区中，否则之后的检查都以错误的姿态为基准
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        if (safety_check(safety, safety->pose, (unsigned char)axis, safety->pose[axis]) != 0) {
+            fprintf(stderr, "限位配置 %s：初始姿态不合法，%s\n", path, safety->reason);
+            exit(1);
+        }
+    }
+    printf("已加载限位配置 %s：%d 个禁止区\n", path, safety->zone_count);
+}
+
+// 检查姿态中某个轴设置为angle后是否合法，不修改状态；返回0表示通过
+int safety_check(safety_table_t *safety, const unsigned char *pose, unsigned char axis, unsigned char angle) {
+    if (axis >= AXIS_COUNT) {
+        safety->reject_axis++;
+        snprintf(safety->reason, sizeof(safety->reason), "无效的轴号 %d", axis + 1);
+        return -1;
+    }
+    if (!(safety->angle_ok[axis][angle >> 5] & (1u << (angle & 31)))) {
+        safety->reject_limit[axis]++;
+        snprintf(safety->reason, sizeof(safety->reason), "轴 %d 的角度 %d° 超出限位 %d~%d°",
+                 axis + 1, angle, safety->limit_min[axis], safety->limit_max[axis]);
+        return -1;
+    }
+
+    // 新姿态下所有轴都满足条件的禁止区
+    uint32_t hits = safety->zone_mask;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        hits &= safety->zone_hits[i][i == axis ? angle : pose[i]];
+    }
+    if (hits) {
+        int zone = __builtin_ctz(hits);
+        safety->reject_zone[zone]++;
+        snprintf(safety->reason, sizeof(safety->reason), "轴 %d 设置为 %d° 将进入禁止区 %s",
+                 axis + 1, angle, safety->zone_names[zone]);
+        return -1;
+    }
+    return 0;
+}
+
+// 生成按规则统计的拒绝次数（只列出非零项）
+void format_safety_stats(safety_table_t *safety, char *out, size_t size) {
+    size_t used = snprintf(out, size, "拒绝：轴号 %lu 次", safety->reject_axis);
+    for (int axis = 0; axis < AXIS_COUNT && used < size; axis++) {
+        if (safety->reject_limit[axis]) {
+            used += snprintf(out + used, size - used, "，轴%d限位 %lu 次", axis + 1, safety->reject_limit[axis]);
+        }
+    }
+    for (int zone = 0; zone < safety->zone_count && used < size; zone++) {
+        if (safety->reject_zone[zone]) {
+            used += snprintf(out + used, size - used, "，禁止区%s %lu 次", safety->zone_names[zone], safety->reject_zone[zone]);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SAFETY_H
+#define SAFETY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AXIS_COUNT 6                   // 机械臂轴数
+#define MAX_ZONES 32                   // 禁止区数量上限（每个禁止区占用一位）
+#define ZONE_NAME_LEN 32
+#define LIMITS_CONFIG "limits.conf"    // 默认的限位配置文件，与程序放在同一目录
+
+// 安全限位表：加载配置时预先展开成查找表，每帧只需常数次查表
+typedef struct {
+    uint32_t angle_ok[AXIS_COUNT][8];        // 每个轴允许角度的位图（256位）
+    uint32_t zone_hits[AXIS_COUNT][256];     // 某轴处于某角度时满足条件的禁止区位掩码
+    uint32_t zone_mask;                      // 已定义的禁止区
+    int zone_count;
+    char zone_names[MAX_ZONES][ZONE_NAME_LEN];
+    unsigned char limit_min[AXIS_COUNT];     // 仅用于拒绝信息
+    unsigned char limit_max[AXIS_COUNT];
+    unsigned char pose[AXIS_COUNT];          // 已放行的最新姿态
+
+    // 按规则统计的拒绝次数
+    unsigned long reject_axis;               // 无效轴号
+    unsigned long reject_limit[AXIS_COUNT];  // 超出轴限位
+    unsigned long reject_zone[MAX_ZONES];    // 进入禁止区
+    char reason[128];                        // 最近一次拒绝的原因
+} safety_table_t;
+
+// 设置某个轴的限位范围
+void safety_set_limit(safety_table_t *safety, int axis, int min, int max);
+// 解析禁止区定义：zone <名称> <轴号>:<最小>-<最大> ...
+int safety_add_zone(safety_table_t *safety, char *spec, int line_no);
+// 默认限位配置的路径：程序所在目录下的LIMITS_CONFIG，与启动时的工作目录无关
+void default_safety_config_path(char *out, size_t size);
+// 加载限位配置，配置有误或初始姿态不合法时退出程序
+// path为NULL时使用默认路径，文件不存在则使用默认限位（全部0~180°，无禁止区）；指定的文件打不开时退出
+void load_safety_config(safety_table_t *safety, const char *path);
+// 检查姿态中某个轴设置为angle后是否合法，不修改状态；返回0表示通过
+int safety_check(safety_table_t *safety, const unsigned char *pose, unsigned char axis, unsigned char angle);
+// 生成按规则统计的拒绝次数（只列出非零项）
+void format_safety_stats(safety_table_t *safety, char *out, size_t size);
+
+#endif // SAFETY_H
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "safety.h"
+
+// 限位配置解析与safety_check的测试（ctest运行）
+
+static int failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: 检查失败：%s\n", __FILE__, __LINE__, #cond); \
+        failures++; \
+    } \
+} while (0)
+
+static safety_table_t safety;
+
+// 把配置内容写入临时文件，返回文件路径
+const char *write_config(const char *content) {
+    static char path[64];
+    snprintf(path, sizeof(path), "/tmp/safety_test_XXXXXX");
+    int fd = mkstemp(path);
+    if (fd == -1 || write(fd, content, strlen(content)) != (ssize_t)strlen(content)) {
+        perror("写入临时配置失败");
+        exit(1);
+    }
+    close(fd);
+    return path;
+}
+
+// 在子进程中加载配置，返回子进程的退出码（配置错误时load_safety_config会退出程序）
+int load_exit_code(const char *content) {
+    const char *path = write_config(content);
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        freopen("/dev/null", "w", stderr);
+        load_safety_config(&safety, path);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    unlink(path);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// 加载配置（必须成功）
+void load(const char *content) {
+    const char *path = write_config(content);
+    load_safety_config(&safety, path);
+    unlink(path);
+}
+
+void test_limits(void) {
+    load("# 注释\n"
+         "axis 5 60 140\n"
+         "  axis 1 10 170\n");
+    unsigned char pose[AXIS_COUNT] = { 90, 90, 90, 90, 90, 90 };
+
+    CHECK(safety_check(&safety, pose, 4, 60) == 0);
+    CHECK(safety_check(&safety, pose, 4, 140) == 0);
+    CHECK(safety_check(&safety, pose, 4, 59) != 0);
+    CHECK(safety_check(&safety, pose, 4, 141) != 0);
+    CHECK(safety.reject_limit[4] == 2);
+    CHECK(strstr(safety.reason, "60~140") != NULL);
+    CHECK(safety_check(&safety, pose, 0, 9) != 0);
+    CHECK(safety_check(&safety, pose, 1, 0) == 0);   // 未配置的轴默认0~180
+    CHECK(safety_check(&safety, pose, 1, 181) != 0);
+    CHECK(safety_check(&safety, pose, 6, 90) != 0);  // 轴号越界
+    CHECK(safety.reject_axis == 1);
+}
+
+void test_zones(void) {
+    load("zone 前臂触地 2:110-180 3:0-50\n"
+         "zone 双区间 1:0-10 1:170-180 4:100-120\n");
+    unsigned char pose[AXIS_COUNT] = { 90, 90, 90, 90, 90, 90 };
+    CHECK(safety.zone_count == 2);
+
+    // 只有一个轴进入区间时不算进入禁止区
+    CHECK(safety_check(&safety, pose, 1, 120) == 0);
+    pose[1] = 120;
+    CHECK(safety_check(&safety, pose, 2, 50) != 0);
+    CHECK(safety.reject_zone[0] == 1);
+    CHECK(strstr(safety.reason, "前臂触地") != NULL);
+    CHECK(safety_check(&safety, pose, 2, 51) == 0);
+
+    // 同一轴的多个区间取并集
+    pose[3] = 110;
+    CHECK(safety_check(&safety, pose, 0, 5) != 0);
+    CHECK(safety_check(&safety, pose, 0, 175) != 0);
+    CHECK(safety_check(&safety, pose, 0, 90) == 0);
+    CHECK(safety.reject_zone[1] == 2);
+}
+
+void test_pose(void) {
+    load("pose 80 81 82 83 84 85\n");
+    CHECK(safety.pose[0] == 80 && safety.pose[5] == 85);
+
+    CHECK(load_exit_code("pose 90 90 90 90 90 300\n") == 1);        // 角度越界
+    CHECK(load_exit_code("pose 90 90 90\n") == 1);                  // 角度不足
+    CHECK(load_exit_code("axis 5 60 140\npose 90 90 90 90 30 90\n") == 1);  // 超出限位
+    CHECK(load_exit_code("pose 90 120 40 90 90 90\n"
+                         "zone 前臂触地 2:110-180 3:0-50\n") == 1);  // 初始姿态在禁止区内
+}
+
+void test_errors(void) {
+    CHECK(load_exit_code("axis 7 0 180\n") == 1);
+    CHECK(load_exit_code("axis 1 100 50\n") == 1);
+    CHECK(load_exit_code("zone 空\n") == 1);
+    CHECK(load_exit_code("zone 坏 2:50\n") == 1);
+    CHECK(load_exit_code("limit 1 0 180\n") == 1);
+
+    // 用户指定的文件不存在时退出
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) {
+        freopen("/dev/null", "w", stderr);
+        load_safety_config(&safety, "/nonexistent/limits.conf");
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+}
+
+int main(void) {
+    test_limits();
+    test_zones();
+    test_pose();
+    test_errors();
+    if (failures) {
+        fprintf(stderr, "%d 项检查失败\n", failures);
+        return 1;
+    }
+    printf("限位测试全部通过\n");
+    return 0;
+}
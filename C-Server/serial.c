@@ -0,0 +1,237 @@
+#include "serial.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// 将当前线程绑定到指定CPU核心
+void pin_thread_to_cpu(int cpu, const char *name) {
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        fprintf(stderr, "%s绑定CPU %d 失败: %s\n", name, cpu, strerror(err));
+    } else {
+        printf("%s已绑定到CPU %d\n", name, cpu);
+    }
+}
+
+// 打开串口
+int open_serial_port(const char *port) {
+    int fd = open(port, O_RDWR | O_NOCTTY | O_NDELAY);
+    if (fd == -1) {
+        perror("无法打开串口");
+        exit(1);
+    }
+    return fd;
+}
+
+// 配置串口
+void configure_serial_port(int fd) {
+    struct termios options;
+    tcgetattr(fd, &options);
+
+    // 设置波特率
+    cfsetispeed(&options, B115200);  // 接收波特率
+    cfsetospeed(&options, B115200);  // 发送波特率
+
+    // 设置数据位、停止位、无校验
+    options.c_cflag &= ~PARENB;      // 无校验
+    options.c_cflag &= ~CSTOPB;      // 1个停止位
+    options.c_cflag &= ~CSIZE;       // 清除数据位大小
+    options.c_cflag |= CS8;          // 8个数据位
+
+    options.c_cflag |= CLOCAL | CREAD; // 启动接收器
+
+    // 禁用软件流控
+    options.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+    // 设置串口选项
+    tcsetattr(fd, TCSANOW, &options);
+}
+
+// 向STM32发送指令（仅由串口线程调用）
+// 串口以非阻塞方式打开，写不进去时等待可写，只阻塞串口线程本身
+void send_to_stm32(frame_ring_t *ring, int serial_fd, const unsigned char *buffer, ssize_t len) {
+    ssize_t written = 0;
+    int stalled = 0;
+    while (written < len) {
+        ssize_t n = write(serial_fd, buffer + written, len - written);
+        if (n > 0) {
+            written += n;
+            if (written < len && !stalled) {
+                atomic_fetch_add_explicit(&ring->write_stalls, 1, memory_order_relaxed);
+                stalled = 1;
+            }
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!stalled) {
+                atomic_fetch_add_explicit(&ring->write_stalls, 1, memory_order_relaxed);
+                stalled = 1;
+            }
+            struct pollfd pfd = { .fd = serial_fd, .events = POLLOUT };
+            poll(&pfd, 1, -1);
+            continue;
+        }
+        if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        perror("写入串口失败");
+        atomic_fetch_add_explicit(&ring->frames_failed, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&ring->frames_written, 1, memory_order_relaxed);
+}
+
+// 从STM32接收数据
+ssize_t read_from_stm32(int serial_fd, unsigned char *buffer, size_t size) {
+    return read(serial_fd, buffer, size);
+}
+
+// 串口线程：从队列取出预编码的帧并写入串口
+void *serial_writer_thread(void *arg) {
+    serial_writer_args_t *args = (serial_writer_args_t *)arg;
+    pin_thread_to_cpu(args->cpu, "串口线程");
+
+    serial_frame_t frame;
+    while (1) {
+        ring_pop_wait(args->ring, &frame);
+        send_to_stm32(args->ring, args->serial_fd, frame.data, frame.len);
+        if (frame.delay_us > 0) {
+            usleep(frame.delay_us);
+        }
+    }
+    return NULL;
+}
+
+// 单调时钟（纳秒）
+uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// 从队列中取出到期的帧拼成一批；遇到带节拍的宏动作帧就截止，返回是否有待写入的数据
+int serial_pump_fill(serial_pump_t *pump, frame_ring_t *ring, uint64_t now) {
+    if (pump->off < pump->len) {
+        return 1;
+    }
+    if (now < pump->next_due_ns) {
+        return 0;
+    }
+    pump->len = 0;
+    pump->off = 0;
+    pump->frames = 0;
+    pump->delay_us = 0;
+
+    serial_frame_t frame;
+    while (pump->len + sizeof(frame.data) <= sizeof(pump->data) && ring_try_pop(ring, &frame)) {
+        memcpy(pump->data + pump->len, frame.data, frame.len);
+        pump->len += frame.len;
+        pump->frames++;
+        if (frame.delay_us > 0) {
+            pump->delay_us = frame.delay_us;
+            break;
+        }
+    }
+    return pump->len > 0;
+}
+
+// 记录一次串口写入的结果；整批写完后更新统计并安排下一批的时间
+void serial_pump_written(serial_pump_t *pump, frame_ring_t *ring, ssize_t n, uint64_t now) {
+    pump->off += n;
+    if (pump->off < pump->len) {
+        atomic_fetch_add_explicit(&ring->write_stalls, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&ring->frames_written, pump->frames, memory_order_relaxed);
+    pump->next_due_ns = now + (uint64_t)pump->delay_us * 1000;
+    pump->len = 0;
+    pump->off = 0;
+}
+
+// 将一组0xAA帧按宏动作节拍放入队列；任意一步不合法时整个宏都不执行
+// 返回0表示已入队，-1表示被限位拒绝，-2表示串口队列放不下整个宏而丢弃；失败时姿态不变
+int enqueue_macro(frame_ring_t *ring, safety_table_t *safety, const unsigned char (*buf)[3], int count) {
+    unsigned char pose[AXIS_COUNT];
+    serial_frame_t frames[MACRO_MAX_FRAMES];
+    memcpy(pose, safety->pose, sizeof(pose));
+    for (int i = 0; i < count; i++) {
+        if (safety_check(safety, pose, buf[i][1], buf[i][2]) != 0) {
+            return -1;
+        }
+        pose[buf[i][1]] = buf[i][2];
+        frames[i] = (serial_frame_t){ { buf[i][0], buf[i][1], buf[i][2] }, 3, MACRO_STEP_US };
+    }
+
+    // 整个宏一起入队，不会只执行前几步
+    if (!ring_push_frames(ring, frames, count)) {
+        return -2;
+    }
+    memcpy(safety->pose, pose, sizeof(pose));
+    return 0;
+}
+
+// 原有指令数组（用于处理0xBB协议转化）
+int Reset(frame_ring_t *ring, safety_table_t *safety) {
+    static const unsigned char BUF[6][3] =
+    {
+        {0xaa,0x00,0x5A},
+        {0xaa,0x01,0x5A},
+        {0xaa,0x02,0x5A},
+        {0xaa,0x03,0x5A},
+        {0xaa,0x04,0x5A},
+        {0xaa,0x05,0x5A},
+    };
+    return enqueue_macro(ring, safety, BUF, 4);
+}
+
+int Down(frame_ring_t *ring, safety_table_t *safety) {
+    static const unsigned char BUF[3][3] =
+    {
+        {0xaa,0x01,0x78},
+        {0xaa,0x02,0x3F},
+        {0xaa,0x03,0x48},
+    };
+    return enqueue_macro(ring, safety, BUF, 3);
+}
+
+int Up(frame_ring_t *ring, safety_table_t *safety) {
+    static const unsigned char BUF[3][3] =
+    {
+        {0xaa,0x03,0x5A},
+        {0xaa,0x02,0x5A},
+        {0xaa,0x01,0x5A},
+    };
+    return enqueue_macro(ring, safety, BUF, 3);
+}
+
+int Scrach(frame_ring_t *ring, safety_table_t *safety) {
+    static const unsigned char BUF[2][3] =
+    {
+        {0xaa,0x04,0x3c},    // 夹子张开
+        {0xaa,0x04,0x82},    // 夹子夹紧
+    };
+    return enqueue_macro(ring, safety, BUF, 2);
+}
+
+int Push(frame_ring_t *ring, safety_table_t *safety) {
+    static const unsigned char BUF[1][3] =
+    {
+        {0xaa,0x04,0x3c},    // 夹子张开
+    };
+    return enqueue_macro(ring, safety, BUF, 1);
+}
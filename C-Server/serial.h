@@ -0,0 +1,63 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "frame_ring.h"
+#include "safety.h"
+
+#define MACRO_STEP_US 500000           // 宏动作每一步之间的间隔
+#define SERIAL_BATCH_SIZE 256          // 单线程后端一次串口写入的最大字节数
+#define MACRO_MAX_FRAMES 6             // 单个宏动作最多产生的帧数
+
+// 单线程后端的串口发送状态：把队列中的帧拼成一次写入，并负责宏动作的节拍
+typedef struct {
+    unsigned char data[SERIAL_BATCH_SIZE];
+    size_t len;
+    size_t off;
+    unsigned long frames;                    // 本批包含的帧数
+    unsigned int delay_us;                   // 本批写完后需要等待的时间
+    uint64_t next_due_ns;                    // 下一批最早的发送时间
+} serial_pump_t;
+
+// 串口线程参数
+typedef struct {
+    frame_ring_t *ring;
+    int serial_fd;
+    int cpu;                  // 绑定的CPU核心，-1表示不绑定
+} serial_writer_args_t;
+
+// 将当前线程绑定到指定CPU核心
+void pin_thread_to_cpu(int cpu, const char *name);
+
+// 打开串口
+int open_serial_port(const char *port);
+// 配置串口
+void configure_serial_port(int fd);
+// 向STM32发送指令（仅由串口线程调用）
+// 串口以非阻塞方式打开，写不进去时等待可写，只阻塞串口线程本身
+void send_to_stm32(frame_ring_t *ring, int serial_fd, const unsigned char *buffer, ssize_t len);
+// 从STM32接收数据
+ssize_t read_from_stm32(int serial_fd, unsigned char *buffer, size_t size);
+// 串口线程：从队列取出预编码的帧并写入串口
+void *serial_writer_thread(void *arg);
+
+// 单调时钟（纳秒）
+uint64_t monotonic_ns(void);
+// 从队列中取出到期的帧拼成一批；遇到带节拍的宏动作帧就截止，返回是否有待写入的数据
+int serial_pump_fill(serial_pump_t *pump, frame_ring_t *ring, uint64_t now);
+// 记录一次串口写入的结果；整批写完后更新统计并安排下一批的时间
+void serial_pump_written(serial_pump_t *pump, frame_ring_t *ring, ssize_t n, uint64_t now);
+
+// 将一组0xAA帧按宏动作节拍放入队列；任意一步不合法时整个宏都不执行
+// 返回0表示已入队，-1表示被限位拒绝，-2表示串口队列放不下整个宏而丢弃；失败时姿态不变
+int enqueue_macro(frame_ring_t *ring, safety_table_t *safety, const unsigned char (*buf)[3], int count);
+// 原有指令数组（用于处理0xBB协议转化），返回值同enqueue_macro
+int Reset(frame_ring_t *ring, safety_table_t *safety);
+int Down(frame_ring_t *ring, safety_table_t *safety);
+int Up(frame_ring_t *ring, safety_table_t *safety);
+int Scrach(frame_ring_t *ring, safety_table_t *safety);
+int Push(frame_ring_t *ring, safety_table_t *safety);
+
+#endif // SERIAL_H
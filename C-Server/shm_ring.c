@@ -0,0 +1,65 @@
+#include "shm_ring.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// 初始化共享内存队列（由中转程序调用）
+void shm_ring_init(shm_ring_t *ring) {
+    memset(ring, 0, sizeof(*ring));
+    ring->magic = SHM_RING_MAGIC;
+    ring->size = SHM_RING_SIZE;
+}
+
+// 写入一条指令，队列满或指令过长时返回-1
+int shm_ring_push(shm_ring_t *ring, const unsigned char *data, size_t len) {
+    if (len == 0 || len > SHM_COMMAND_MAX) {
+        return -1;
+    }
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail >= SHM_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->drops, 1, memory_order_relaxed);
+        return -1;
+    }
+    shm_command_t *slot = &ring->slots[head & (SHM_RING_SIZE - 1)];
+    slot->len = (unsigned char)len;
+    memcpy(slot->data, data, len);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_seq_cst);
+    return 0;
+}
+
+// 读取一条指令，队列空时返回0
+int shm_ring_pop(shm_ring_t *ring, shm_command_t *command) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail == head) {
+        return 0;
+    }
+    *command = ring->slots[tail & (SHM_RING_SIZE - 1)];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+// 队列中是否有未读取的指令
+int shm_ring_pending(shm_ring_t *ring) {
+    return atomic_load_explicit(&ring->head, memory_order_seq_cst) !=
+           atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+// 队列剩余空间（由生产者调用）
+uint32_t shm_ring_space(shm_ring_t *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    return SHM_RING_SIZE - (head - tail);
+}
+
+// 写入一批指令后调用：中转程序在等待时通过eventfd唤醒它
+void shm_ring_notify(shm_ring_t *ring, int event_fd) {
+    if (atomic_load_explicit(&ring->consumer_waiting, memory_order_seq_cst)) {
+        uint64_t one = 1;
+        if (write(event_fd, &one, sizeof(one)) != sizeof(one)) {
+            perror("唤醒中转程序失败");
+        }
+    }
+}
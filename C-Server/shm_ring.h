@@ -0,0 +1,46 @@
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define LOCAL_SOCKET_PATH "/tmp/robot-arm-relay.sock"  // 本地Unix域socket
+#define LOCAL_SHM_HELLO "SHMR"                         // 申请共享内存通道的握手（4字节）
+#define LOCAL_SHM_REPLY "SHM OK"                       // 握手回复，附带共享内存和eventfd
+#define SHM_RING_MAGIC 0x51524853u                     // "SHRQ"
+#define SHM_RING_SIZE 4096                             // 共享内存队列容量（必须为2的幂）
+#define SHM_COMMAND_MAX 7                              // 单条指令最大长度
+
+// 共享内存中的一条指令，内容与TCP协议相同（0xAA/0xBB帧）
+typedef struct {
+    unsigned char len;
+    unsigned char data[SHM_COMMAND_MAX];
+} shm_command_t;
+
+// 本地生产者与中转程序之间的单生产者单消费者队列，放在memfd共享内存中
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    _Alignas(64) _Atomic uint32_t head;       // 下一个写入位置（仅生产者修改）
+    _Alignas(64) _Atomic uint32_t tail;       // 下一个读取位置（仅中转程序修改）
+    _Alignas(64) _Atomic uint32_t consumer_waiting;  // 中转程序是否在等待eventfd
+    _Atomic uint64_t drops;                   // 队列满时生产者丢弃的指令数
+
+    shm_command_t slots[SHM_RING_SIZE];
+} shm_ring_t;
+
+// 初始化共享内存队列（由中转程序调用）
+void shm_ring_init(shm_ring_t *ring);
+// 写入一条指令，队列满或指令过长时返回-1
+int shm_ring_push(shm_ring_t *ring, const unsigned char *data, size_t len);
+// 读取一条指令，队列空时返回0
+int shm_ring_pop(shm_ring_t *ring, shm_command_t *command);
+// 队列中是否有未读取的指令
+int shm_ring_pending(shm_ring_t *ring);
+// 队列剩余空间（由生产者调用）
+uint32_t shm_ring_space(shm_ring_t *ring);
+// 写入一批指令后调用：中转程序在等待时通过eventfd唤醒它
+void shm_ring_notify(shm_ring_t *ring, int event_fd);
+
+#endif // SHM_RING_H
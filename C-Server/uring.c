@@ -0,0 +1,123 @@
+#include "uring.h"
+
+#ifdef RELAY_HAVE_URING
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+// 创建io_uring并映射提交/完成队列，失败返回-1
+int uring_init(uring_t *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd == -1) {
+        return -1;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        sq_size = cq_size = sq_size > cq_size ? sq_size : cq_size;
+    }
+
+    unsigned char *sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 ring->fd, IORING_OFF_SQ_RING);
+    if (sq_ptr == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+    unsigned char *cq_ptr = sq_ptr;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_CQ_RING);
+        if (cq_ptr == MAP_FAILED) {
+            close(ring->fd);
+            return -1;
+        }
+    }
+    ring->sqes = mmap(NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        close(ring->fd);
+        return -1;
+    }
+
+    ring->sq_head = (unsigned *)(sq_ptr + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq_ptr + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq_ptr + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq_ptr + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq_ptr + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq_ptr + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq_ptr + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq_ptr + params.cq_off.cqes);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_local_tail = *ring->sq_tail;
+    return 0;
+}
+
+// 注册固定缓冲区，内核只需映射一次
+int uring_register_buffers(uring_t *ring, const struct iovec *iovs, unsigned count) {
+    return (int)syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_BUFFERS, iovs, count);
+}
+
+// 取一个空闲的SQE
+struct io_uring_sqe *uring_get_sqe(uring_t *ring, uint64_t user_data) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) {
+        return NULL;
+    }
+    unsigned index = ring->sq_local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = user_data;
+    ring->sq_array[index] = index;
+    ring->sq_local_tail++;
+    return sqe;
+}
+
+// 准备一个固定缓冲区的读写操作
+void uring_prep_rw_fixed(uring_t *ring, int opcode, uint64_t user_data, int fd,
+                         void *buf, unsigned len, unsigned buf_index) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ring, user_data);
+    sqe->opcode = (unsigned char)opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = (uint64_t)-1;                 // 流式文件，使用当前位置
+    sqe->buf_index = (unsigned short)buf_index;
+}
+
+// 准备一个poll操作
+void uring_prep_poll(uring_t *ring, uint64_t user_data, int fd, unsigned events) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ring, user_data);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll_events = (unsigned short)events;
+}
+
+// 准备一个相对超时
+void uring_prep_timeout(uring_t *ring, uint64_t user_data, struct __kernel_timespec *ts) {
+    struct io_uring_sqe *sqe = uring_get_sqe(ring, user_data);
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)ts;
+    sqe->len = 1;
+}
+
+// 一次系统调用提交所有准备好的SQE并等待至少一个完成事件
+int uring_submit_and_wait(uring_t *ring) {
+    unsigned submit = ring->sq_local_tail - *ring->sq_tail;
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    int ret;
+    do {
+        ret = (int)syscall(__NR_io_uring_enter, ring->fd, submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+        submit = 0;
+    } while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+#endif
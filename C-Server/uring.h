@@ -0,0 +1,47 @@
+#ifndef URING_H
+#define URING_H
+
+// io_uring后端直接使用系统调用，不依赖liburing；头文件或系统调用号缺失时只编译epoll和阻塞后端
+#include <sys/syscall.h>
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define RELAY_HAVE_URING 1
+#endif
+#endif
+
+#ifdef RELAY_HAVE_URING
+
+#include <stdint.h>
+#include <sys/uio.h>
+
+// 最小的io_uring封装（仅包含本程序用到的部分）
+typedef struct {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned sq_entries;
+    unsigned sq_local_tail;                  // 已准备但未提交的SQE位置
+} uring_t;
+
+// 创建io_uring并映射提交/完成队列，失败返回-1
+int uring_init(uring_t *ring, unsigned entries);
+// 注册固定缓冲区，内核只需映射一次
+int uring_register_buffers(uring_t *ring, const struct iovec *iovs, unsigned count);
+// 取一个空闲的SQE
+struct io_uring_sqe *uring_get_sqe(uring_t *ring, uint64_t user_data);
+// 准备一个固定缓冲区的读写操作
+void uring_prep_rw_fixed(uring_t *ring, int opcode, uint64_t user_data, int fd,
+                         void *buf, unsigned len, unsigned buf_index);
+// 准备一个poll操作
+void uring_prep_poll(uring_t *ring, uint64_t user_data, int fd, unsigned events);
+// 准备一个相对超时
+void uring_prep_timeout(uring_t *ring, uint64_t user_data, struct __kernel_timespec *ts);
+// 一次系统调用提交所有准备好的SQE并等待至少一个完成事件
+int uring_submit_and_wait(uring_t *ring);
+
+#endif
+
+#endif // URING_H
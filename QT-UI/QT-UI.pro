@@ -18,10 +18,14 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    motionplayer.cpp \
+    motionsequence.cpp
 
 HEADERS += \
-    mainwindow.h
+    mainwindow.h \
+    motionplayer.h \
+    motionsequence.h
 
 FORMS += \
     mainwindow.ui
@@ -29,6 +33,9 @@ FORMS += \
 TRANSLATIONS += \
     QT-UI_zh_CN.ts
 
+# 中转程序客户端库
+include(../RobotClient/robotclient.pri)
+
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
@@ -1,8 +1,11 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 
+#include <QFileDialog>
+
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), ui(new Ui::MainWindow), socket(new QTcpSocket(this)) {
+    : QMainWindow(parent), ui(new Ui::MainWindow), client(new RobotClient(this)),
+      recording(false), playerThread(new QThread(this)), player(new MotionPlayer(client)) {
     ui->setupUi(this);
     this->setWindowTitle("机械臂控制中心v1.0 Alpha By:RoyZ");
     setFixedSize(1100, 700);
@@ -53,14 +56,31 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->ButtonTestConnect, &QPushButton::clicked, this, &MainWindow::onTestConnectionClicked);
     connect(ui->ButtonQuit, &QPushButton::clicked, this, &MainWindow::onQuitClicked);
 
-    // 3. 网络连接信号
-    connect(socket, &QTcpSocket::connected, this, &MainWindow::onSocketConnected);
-    connect(socket, &QTcpSocket::disconnected, this, &MainWindow::onSocketDisconnected);
-    connect(socket, &QTcpSocket::readyRead, this, &MainWindow::onSocketReadyRead);
-    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), this, &MainWindow::onSocketError);
+    // 3. 网络连接信号（客户端在 I/O 线程中发出，排队回到界面线程）
+    connect(client, &RobotClient::connected, this, &MainWindow::onSocketConnected);
+    connect(client, &RobotClient::disconnected, this, &MainWindow::onSocketDisconnected);
+    connect(client, &RobotClient::replyReceived, this, &MainWindow::onReplyReceived);
+    connect(client, &RobotClient::errorOccurred, this, &MainWindow::onClientError);
+
+    // 4. 录制与回放：回放器运行在独立线程并直接发送，界面只同步滑块
+    qRegisterMetaType<MotionSequence>();
+    player->moveToThread(playerThread);
+    connect(playerThread, &QThread::finished, player, &QObject::deleteLater);
+    connect(player, &MotionPlayer::frameSent, this, &MainWindow::onPlaybackFrame);
+    connect(player, &MotionPlayer::finished, this, &MainWindow::onPlaybackFinished);
+    playerThread->start(QThread::TimeCriticalPriority);
+
+    connect(ui->ButtonRecord, &QPushButton::clicked, this, &MainWindow::onRecordClicked);
+    connect(ui->ButtonSaveSeq, &QPushButton::clicked, this, &MainWindow::onSaveSequenceClicked);
+    connect(ui->ButtonLoadSeq, &QPushButton::clicked, this, &MainWindow::onLoadSequenceClicked);
+    connect(ui->ButtonPlay, &QPushButton::clicked, this, &MainWindow::onPlayClicked);
+    connect(ui->ButtonStopPlay, &QPushButton::clicked, this, &MainWindow::onStopPlayClicked);
 }
 
 MainWindow::~MainWindow() {
+    player->stop();
+    playerThread->quit();
+    playerThread->wait();
     delete ui;
 }
 
@@ -72,13 +92,7 @@ void MainWindow::onSendAngleClicked() {
     QDoubleSpinBox *spinBox = findChild<QDoubleSpinBox*>(QString("spinBox%1").arg(axis+1));
 
     double angle = spinBox->value();
-    QByteArray command;
-    command.append(0xAA); // 包头
-    command.append(axis); // 轴编号
-    command.append(static_cast<int>(angle) & 0xFF); // 角度数据（示例：简单发送整数部分）
-
-    if (socket->isOpen()) {
-        socket->write(command);
+    if (client->setJoint(axis, static_cast<int>(angle)) != 0) { // 角度数据（示例：简单发送整数部分）
         logMessage(QString("发送轴 %1 的角度：%2°").arg(axis+1).arg(angle));
     } else {
         logMessage("发送失败：未连接到服务器");
@@ -91,14 +105,17 @@ void MainWindow::onSliderValueChanged(int value) {
     QDoubleSpinBox *spinBox = findChild<QDoubleSpinBox*>(QString("spinBox%1").arg(axis+1));
     spinBox->setValue(static_cast<double>(value));  // 更新 SpinBox
 
-    // Send the updated angle to the server
-    QByteArray command;
-    command.append(0xAA); // 包头
-    command.append(axis); // 轴编号
-    command.append(static_cast<int>(value) & 0xFF); // 角度数据（示例：简单发送整数部分）
+    // 录制中：记录滑块动作及其时间
+    if (recording) {
+        MotionFrame frame;
+        frame.timeUs = static_cast<quint32>(recordTimer.nsecsElapsed() / 1000);
+        frame.axis = static_cast<quint8>(axis);
+        frame.angle = static_cast<quint8>(value);
+        sequence.frames.append(frame);
+    }
 
-    if (socket->isOpen()) {
-        socket->write(command);
+    // 实时发送：不等待回复，拖动时连续的帧由客户端合并写出
+    if (client->setJoint(axis, value) != 0) {
         logMessage(QString("实时发送轴 %1 的角度：%2°").arg(axis+1).arg(value));
     } else {
         logMessage("发送失败：未连接到服务器");
@@ -107,171 +124,83 @@ void MainWindow::onSliderValueChanged(int value) {
 
 
 void MainWindow::onSendAllAnglesClicked() {
-    // 依次发送每个轴的角度值，并等待响应
+    // 6个轴的角度一次写出，中转程序依次回复
+    QVector<int> angles;
     for (int i = 0; i < 6; ++i) {
         QSlider *slider = findChild<QSlider*>(QString("slider%1").arg(i+1));
-        int axis = i; // 轴编号
-        double angle = slider->value();
-
-        QByteArray command;
-        command.append(0xAA); // 包头
-        command.append(axis); // 轴编号
-        command.append(static_cast<int>(angle) & 0xFF); // 角度数据（示例：简单发送整数部分）
-
-        if (socket->isOpen()) {
-            socket->write(command);
-            if (socket->waitForBytesWritten()) {  // 等待数据写入完成
-                if (socket->waitForReadyRead()) {  // 等待服务器响应
-                    QByteArray response = socket->readAll();
-                    logMessage(QString("正在发送轴 %1 的角度").arg(i+1));
-                }
-            }
-        } else {
-            logMessage("发送失败：未连接到服务器");
-        }
+        angles.append(slider->value());
+    }
 
-        // 等待服务器处理完前一个指令再发送下一个
-        QThread::msleep(100);
+    if (client->setPose(angles) != 0) {
+        logMessage("正在发送全部轴的角度");
+    } else {
+        logMessage("发送失败：未连接到服务器");
     }
 }
 
 void MainWindow::onResetClicked() {
-    if (socket->isOpen()) {
-            // 确认服务器收到并重置后，重置所有 SpinBox
+    if (client->isConnected()) {
+        // 重置所有 SpinBox，滑块联动后逐轴实时发送
         for (int i = 0; i < 6; ++i) {
             QDoubleSpinBox *spinBox = findChild<QDoubleSpinBox*>(QString("spinBox%1").arg(i+1));
             if (spinBox) {
-                spinBox->setValue(90); // 将 SpinBox 的值重置为 0
-            }
-        logMessage(QString("正在重置轴的角度"));
-        }
-        if (socket->waitForBytesWritten()) {
-            // 等待数据写入完成
-            if (socket->waitForReadyRead()) {
-                // 等待服务器响应
-                QByteArray response = socket->readAll();
+                spinBox->setValue(90); // 将 SpinBox 的值重置为 90
             }
         }
+        logMessage(QString("正在重置轴的角度"));
     } else {
         logMessage("发送失败：未连接到服务器");
     }
-    /*
-    QByteArray command;
-    command.append(0xBB); // BB包头
-    command.append(static_cast<char>(0x00)); // 重置命令
-    if (socket->isOpen()) {
-        socket->write(command);
-        if (socket->waitForBytesWritten()) {
-            // 等待数据写入完成
-            if (socket->waitForReadyRead()) {
-                // 等待服务器响应
-                QByteArray response = socket->readAll();
-                logMessage(QString("正在重置轴的角度"));
-
-                // 确认服务器收到并重置后，重置所有 SpinBox
-                for (int i = 0; i < 6; ++i) {
-                    QDoubleSpinBox *spinBox = findChild<QDoubleSpinBox*>(QString("spinBox%1").arg(i+1));
-                    if (spinBox) {
-                        spinBox->setValue(90); // 将 SpinBox 的值重置为 0
-                    }
-                }
-            }
-        }
-    } else {
-        logMessage("发送失败：未连接到服务器");
-    }*/
 }
 
 
 
 void MainWindow::onDownClicked() {
-        QByteArray command;
-        command.append(0xBB); // BB包头
-        command.append(static_cast<char>(0x01));
-        logMessage(QString("正在低头"));
-        if (socket->isOpen()) {
-            socket->write(command);
-            if (socket->waitForBytesWritten()) {  // 等待数据写入完成
-                if (socket->waitForReadyRead()) {  // 等待服务器响应
-                    QByteArray response = socket->readAll();
-                }
-            }
-        } else {
-            logMessage("发送失败：未连接到服务器");
-        }
+    logMessage(QString("正在低头"));
+    if (client->runMacro(RobotProtocol::MacroDown) == 0) {
+        logMessage("发送失败：未连接到服务器");
+    }
 }
 
 void MainWindow::onUpClicked() {
-        QByteArray command;
-        command.append(0xBB); // BB包头
-        command.append(static_cast<char>(0x02));
-        logMessage(QString("正在整体抬头"));
-        if (socket->isOpen()) {
-            socket->write(command);
-            if (socket->waitForBytesWritten()) {  // 等待数据写入完成
-                if (socket->waitForReadyRead()) {  // 等待服务器响应
-                    QByteArray response = socket->readAll();
-                }
-            }
-        } else {
-            logMessage("发送失败：未连接到服务器");
-        }
+    logMessage(QString("正在整体抬头"));
+    if (client->runMacro(RobotProtocol::MacroUp) == 0) {
+        logMessage("发送失败：未连接到服务器");
+    }
 }
 
 void MainWindow::onScrachClicked() {
-        QByteArray command;
-        command.append(0xBB); // BB包头
-        command.append(static_cast<char>(0x03));
-        logMessage(QString("正在抓取"));
-        if (socket->isOpen()) {
-            socket->write(command);
-            if (socket->waitForBytesWritten()) {  // 等待数据写入完成
-                if (socket->waitForReadyRead()) {  // 等待服务器响应
-                    QByteArray response = socket->readAll();
-                }
-            }
-        } else {
-            logMessage("发送失败：未连接到服务器");
-        }
+    logMessage(QString("正在抓取"));
+    if (client->runMacro(RobotProtocol::MacroScrach) == 0) {
+        logMessage("发送失败：未连接到服务器");
+    }
 }
 
 void MainWindow::onPushClicked() {
-        QByteArray command;
-        command.append(0xBB); // BB包头
-        command.append(static_cast<char>(0x04));
-        logMessage(QString("正在放下"));
-        if (socket->isOpen()) {
-            socket->write(command);
-            if (socket->waitForBytesWritten()) {  // 等待数据写入完成
-                if (socket->waitForReadyRead()) {  // 等待服务器响应
-                    QByteArray response = socket->readAll();
-                }
-            }
-        } else {
-            logMessage("发送失败：未连接到服务器");
-        }
+    logMessage(QString("正在放下"));
+    if (client->runMacro(RobotProtocol::MacroPush) == 0) {
+        logMessage("发送失败：未连接到服务器");
+    }
 }
 
 
-// 连接面板：连接服务器
+// 连接面板：连接服务器（断线后自动重连）
 void MainWindow::onConnectClicked() {
     QString ip = ui->LineEditIP->text();
     quint16 port = ui->LineEditPORT->text().toUShort();
-    socket->connectToHost(ip, port);
+    client->connectToHost(ip, port);
     logMessage("尝试连接到服务器...");
 }
 
 // 连接面板：断开连接
 void MainWindow::onDisconnectClicked() {
-    socket->disconnectFromHost();
+    client->disconnectFromHost();
     logMessage("断开连接...");
 }
 
 // 连接面板：测试连接
 void MainWindow::onTestConnectionClicked() {
-    if (socket->isOpen()) {
-        QByteArray testMessage = "TEST";
-        socket->write(testMessage);
+    if (client->test() != 0) {
         logMessage("发送测试连接指令...");
     } else {
         logMessage("测试失败：未连接到服务器");
@@ -280,15 +209,117 @@ void MainWindow::onTestConnectionClicked() {
 
 // 连接面板：QUIT
 void MainWindow::onQuitClicked() {
-    if (socket->isOpen()) {
-        QByteArray quitMessage = "quit";
-        socket->write(quitMessage);
+    if (client->quit() != 0) {
         logMessage("发送QUIT指令...");
     } else {
         logMessage("发送失败：未连接到服务器");
     }
 }
 
+// 录制：开始/停止
+void MainWindow::onRecordClicked() {
+    if (!recording) {
+        if (player->isPlaying()) {
+            logMessage("录制失败：正在回放");
+            return;
+        }
+        sequence.frames.clear();
+        recordTimer.start();
+        recording = true;
+        ui->ButtonRecord->setText("停止录制");
+        logMessage("开始录制滑块动作...");
+    } else {
+        recording = false;
+        ui->ButtonRecord->setText("录制");
+        logMessage(QString("录制结束：共 %1 帧，时长 %2 秒")
+                   .arg(sequence.frames.size()).arg(sequence.durationUs() / 1e6, 0, 'f', 2));
+    }
+}
+
+// 录制：保存序列文件
+void MainWindow::onSaveSequenceClicked() {
+    if (sequence.frames.isEmpty()) {
+        logMessage("保存失败：没有录制的动作");
+        return;
+    }
+    QString path = QFileDialog::getSaveFileName(this, "保存动作序列", QString(), "动作序列 (*.rseq)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (sequence.save(path)) {
+        logMessage("动作序列已保存：" + path);
+    } else {
+        logMessage("保存失败：无法写入 " + path);
+    }
+}
+
+// 录制：载入序列文件
+void MainWindow::onLoadSequenceClicked() {
+    if (recording || player->isPlaying()) {
+        logMessage("载入失败：正在录制或回放");
+        return;
+    }
+    QString path = QFileDialog::getOpenFileName(this, "载入动作序列", QString(), "动作序列 (*.rseq)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (sequence.load(path)) {
+        logMessage(QString("已载入动作序列：共 %1 帧，时长 %2 秒")
+                   .arg(sequence.frames.size()).arg(sequence.durationUs() / 1e6, 0, 'f', 2));
+    } else {
+        logMessage("载入失败：文件格式不正确 " + path);
+    }
+}
+
+// 回放：开始
+void MainWindow::onPlayClicked() {
+    if (!client->isConnected()) {
+        logMessage("回放失败：未连接到服务器");
+        return;
+    }
+    if (recording) {
+        logMessage("回放失败：正在录制");
+        return;
+    }
+    if (sequence.frames.isEmpty()) {
+        logMessage("回放失败：没有可回放的动作");
+        return;
+    }
+    if (!player->start()) {
+        logMessage("回放失败：正在回放");
+        return;
+    }
+
+    double speed = ui->spinBoxSpeed->value();
+    bool loop = ui->checkBoxLoop->isChecked();
+    QMetaObject::invokeMethod(player, "play", Qt::QueuedConnection,
+                              Q_ARG(MotionSequence, sequence), Q_ARG(double, speed), Q_ARG(bool, loop));
+    logMessage(QString("开始回放：%1 帧，速度 %2 倍%3")
+               .arg(sequence.frames.size()).arg(speed).arg(loop ? "，循环" : ""));
+}
+
+// 回放：停止
+void MainWindow::onStopPlayClicked() {
+    player->stop();
+}
+
+// 回放：同步界面（不触发滑块的实时发送）
+void MainWindow::onPlaybackFrame(int axis, int angle) {
+    QSlider *slider = findChild<QSlider*>(QString("slider%1").arg(axis+1));
+    QDoubleSpinBox *spinBox = findChild<QDoubleSpinBox*>(QString("spinBox%1").arg(axis+1));
+    if (slider && spinBox) {
+        QSignalBlocker sliderBlocker(slider);
+        QSignalBlocker spinBoxBlocker(spinBox);
+        slider->setValue(angle);
+        spinBox->setValue(angle);
+    }
+}
+
+// 回放：结束
+void MainWindow::onPlaybackFinished(qint64 maxLateUs) {
+    logMessage(QString("回放结束，最大时间偏差 %1 ms").arg(maxLateUs / 1000.0, 0, 'f', 2));
+}
+
 // 网络事件：连接成功
 void MainWindow::onSocketConnected() {
     logMessage("成功连接到服务器");
@@ -301,14 +332,16 @@ void MainWindow::onSocketDisconnected() {
 
 
 // 网络事件：错误处理
-void MainWindow::onSocketError(QAbstractSocket::SocketError socketError) {
-    logMessage("连接错误：" + socket->errorString());
+void MainWindow::onClientError(const QString &message) {
+    logMessage("连接错误：" + message);
 }
 
-// 网络事件：读取服务器返回数据
-void MainWindow::onSocketReadyRead() {
-    QByteArray data = socket->readAll();
-    logMessage("收到服务器数据：" + QString(data));
+// 网络事件：服务器对每条指令的回复
+void MainWindow::onReplyReceived(quint64 id, bool accepted, const QString &reply, qint64 rttUs) {
+    Q_UNUSED(id);
+    Q_UNUSED(accepted);
+    Q_UNUSED(rttUs);
+    logMessage("收到服务器数据：" + reply);
 }
 
 // 日志输出
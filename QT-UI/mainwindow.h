@@ -2,12 +2,16 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QTcpSocket>
 #include <QSlider>
 #include <QDoubleSpinBox>
 #include <QPushButton>
 #include <QTextBrowser>
 #include <QThread>
+#include <QElapsedTimer>
+
+#include "motionsequence.h"
+#include "motionplayer.h"
+#include "robotclient.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -38,15 +42,31 @@ private slots:
     void onTestConnectionClicked();          // 测试连接
     void onQuitClicked();                    // quit!!!
 
+    // 录制与回放槽函数
+    void onRecordClicked();                  // 开始/停止录制
+    void onSaveSequenceClicked();            // 保存序列文件
+    void onLoadSequenceClicked();            // 载入序列文件
+    void onPlayClicked();                    // 开始回放
+    void onStopPlayClicked();                // 停止回放
+    void onPlaybackFrame(int axis, int angle);
+    void onPlaybackFinished(qint64 maxLateUs);
+
     // 网络数据处理
     void onSocketConnected();
     void onSocketDisconnected();
-    void onSocketError(QAbstractSocket::SocketError socketError);
-    void onSocketReadyRead();
+    void onClientError(const QString &message);
+    void onReplyReceived(quint64 id, bool accepted, const QString &reply, qint64 rttUs);
 
 private:
     Ui::MainWindow *ui;
-    QTcpSocket *socket;
+    RobotClient *client;                     // 与中转程序的连接，收发在独立的 I/O 线程中
+
+    // 录制与回放
+    MotionSequence sequence;                 // 当前录制/载入的动作序列
+    QElapsedTimer recordTimer;
+    bool recording;
+    QThread *playerThread;
+    MotionPlayer *player;
 
     // 辅助方法
     void logMessage(const QString &message); // 控制台日志输出
@@ -0,0 +1,93 @@
+#include "motionplayer.h"
+
+#include <QThread>
+
+// 距离发送时间超过该值时先休眠，剩余时间自旋等待，保证毫秒以内的精度
+static const qint64 SPIN_THRESHOLD_NS = 2000000;
+// 单次休眠上限，保证停止请求能及时响应
+static const qint64 MAX_SLEEP_NS = 20000000;
+
+MotionPlayer::MotionPlayer(RobotClient *client, QObject *parent)
+    : QObject(parent), client(client), stopRequested(0), playing(0) {
+}
+
+// 回放状态在界面线程中设置，而不是等到play()在工作线程中开始执行：
+// 连续点击回放不会排入两次play，play开始前点击的停止也不会被清除
+bool MotionPlayer::start() {
+    if (!playing.testAndSetOrdered(0, 1)) {
+        return false;
+    }
+    stopRequested.storeRelease(0);
+    return true;
+}
+
+void MotionPlayer::stop() {
+    stopRequested.storeRelease(1);
+}
+
+bool MotionPlayer::isPlaying() const {
+    return playing.loadAcquire() != 0;
+}
+
+// 预先把整段序列换算好发送时间，回放循环中只剩等待和发送
+QVector<MotionPlayer::PlaybackFrame> MotionPlayer::buildFrames(const MotionSequence &sequence, double speed) const {
+    QVector<PlaybackFrame> frames;
+    frames.reserve(sequence.frames.size());
+    for (const MotionFrame &frame : sequence.frames) {
+        PlaybackFrame playback;
+        playback.dueNs = static_cast<qint64>(frame.timeUs * 1000.0 / speed);
+        playback.axis = frame.axis;
+        playback.angle = frame.angle;
+        frames.append(playback);
+    }
+    return frames;
+}
+
+// 等待到指定时间点：先粗略休眠，最后一段自旋；收到停止请求时返回false
+bool MotionPlayer::waitUntil(const QElapsedTimer &clock, qint64 dueNs) {
+    while (true) {
+        if (stopRequested.loadAcquire()) {
+            return false;
+        }
+        qint64 remaining = dueNs - clock.nsecsElapsed();
+        if (remaining <= 0) {
+            return true;
+        }
+        if (remaining > SPIN_THRESHOLD_NS) {
+            QThread::usleep(static_cast<unsigned long>(qMin(remaining - SPIN_THRESHOLD_NS / 2, MAX_SLEEP_NS) / 1000));
+        } else {
+            QThread::yieldCurrentThread();
+        }
+    }
+}
+
+// 回放序列（在工作线程中执行，直到播放完毕或被停止）
+void MotionPlayer::play(const MotionSequence &sequence, double speed, bool loop) {
+    if (sequence.frames.isEmpty() || speed <= 0) {
+        playing.storeRelease(0);
+        emit finished(0);
+        return;
+    }
+
+    const QVector<PlaybackFrame> frames = buildFrames(sequence, speed);
+    if (frames.last().dueNs == 0) {
+        loop = false;  // 所有帧都在同一时刻，循环回放没有意义
+    }
+
+    qint64 maxLateNs = 0;
+    QElapsedTimer clock;
+    do {
+        clock.start();
+        for (const PlaybackFrame &frame : frames) {
+            if (!waitUntil(clock, frame.dueNs)) {
+                break;
+            }
+            client->setJoint(frame.axis, frame.angle);
+            maxLateNs = qMax(maxLateNs, clock.nsecsElapsed() - frame.dueNs);  // 以指令交给 RobotClient 的时间计算偏差
+            emit frameSent(frame.axis, frame.angle);
+        }
+    } while (loop && !stopRequested.loadAcquire());
+
+    playing.storeRelease(0);
+    emit finished(maxLateNs / 1000);
+}
@@ -0,0 +1,48 @@
+#ifndef MOTIONPLAYER_H
+#define MOTIONPLAYER_H
+
+#include <QObject>
+#include <QVector>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include "motionsequence.h"
+#include "robotclient.h"
+
+// 动作回放器：运行在独立的工作线程中，按录制时的时间点直接通过 RobotClient 发送指令
+// 使用 QElapsedTimer 计时，不依赖 GUI 线程的定时器，界面繁忙时也不会拖慢节拍
+class MotionPlayer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit MotionPlayer(RobotClient *client, QObject *parent = nullptr);
+
+    bool start();             // 在调用play之前由界面线程调用：标记为正在回放并清除停止请求，已在回放时返回false
+    void stop();              // 可在任意线程调用
+    bool isPlaying() const;
+
+public slots:
+    // 必须先调用start()；结束后清除回放状态并发出finished
+    void play(const MotionSequence &sequence, double speed, bool loop);
+
+signals:
+    void frameSent(int axis, int angle);                             // 已发送的帧，用于同步界面
+    void finished(qint64 maxLateUs);                                 // 回放结束，附带最大时间偏差
+
+private:
+    // 预先计算好的回放帧
+    struct PlaybackFrame {
+        qint64 dueNs;         // 按速度换算后的发送时间
+        int axis;
+        int angle;
+    };
+
+    QVector<PlaybackFrame> buildFrames(const MotionSequence &sequence, double speed) const;
+    bool waitUntil(const QElapsedTimer &clock, qint64 dueNs);
+
+    RobotClient *client;      // 线程安全，可以直接在回放线程中调用
+    QAtomicInt stopRequested;
+    QAtomicInt playing;
+};
+
+#endif // MOTIONPLAYER_H
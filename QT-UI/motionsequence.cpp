@@ -0,0 +1,69 @@
+#include "motionsequence.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <cstring>
+
+static const char SEQUENCE_MAGIC[4] = { 'R', 'A', 'S', 'Q' };
+static const quint8 SEQUENCE_VERSION = 1;
+
+// 保存为二进制序列文件
+bool MotionSequence::save(const QString &path) const {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData(SEQUENCE_MAGIC, sizeof(SEQUENCE_MAGIC));
+    out << SEQUENCE_VERSION << quint8(0) << quint16(0);
+    out << quint32(frames.size());
+    for (const MotionFrame &frame : frames) {
+        out << frame.timeUs << frame.axis << frame.angle;
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+// 读取二进制序列文件，格式不对时保持原有内容不变
+bool MotionSequence::load(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    char magic[4];
+    quint8 version, reserved8;
+    quint16 reserved16;
+    quint32 count;
+    if (in.readRawData(magic, sizeof(magic)) != sizeof(magic) ||
+        memcmp(magic, SEQUENCE_MAGIC, sizeof(magic)) != 0) {
+        return false;
+    }
+    in >> version >> reserved8 >> reserved16 >> count;
+    if (in.status() != QDataStream::Ok || version != SEQUENCE_VERSION ||
+        qint64(count) * 6 > file.size()) {
+        return false;
+    }
+
+    QVector<MotionFrame> loaded;
+    loaded.reserve(int(count));
+    for (quint32 i = 0; i < count; ++i) {
+        MotionFrame frame;
+        in >> frame.timeUs >> frame.axis >> frame.angle;
+        loaded.append(frame);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    frames = loaded;
+    return true;
+}
+
+// 序列总时长（最后一帧的时间）
+quint32 MotionSequence::durationUs() const {
+    return frames.isEmpty() ? 0 : frames.last().timeUs;
+}
@@ -0,0 +1,28 @@
+#ifndef MOTIONSEQUENCE_H
+#define MOTIONSEQUENCE_H
+
+#include <QVector>
+#include <QString>
+#include <QMetaType>
+
+// 录制的一帧滑块动作
+struct MotionFrame {
+    quint32 timeUs;   // 相对录制开始的时间（微秒）
+    quint8 axis;      // 轴编号（0~5）
+    quint8 angle;     // 角度
+};
+
+// 动作序列：按时间顺序排列的帧，可保存为紧凑的二进制文件
+// 文件格式（小端）："RASQ" + 版本(1字节) + 保留(3字节) + 帧数(4字节)，之后每帧6字节：时间(4) 轴(1) 角度(1)
+class MotionSequence {
+public:
+    QVector<MotionFrame> frames;
+
+    bool save(const QString &path) const;
+    bool load(const QString &path);
+    quint32 durationUs() const;
+};
+
+Q_DECLARE_METATYPE(MotionSequence)
+
+#endif // MOTIONSEQUENCE_H
@@ -0,0 +1,19 @@
+QT       += core network
+QT       -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = robotcli
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+include(../robotclient.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,175 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+
+#include "robotclient.h"
+
+// 命令行压测工具：通过 RobotClient 以指定速率连续发送关节指令，统计回复、拒绝和往返延迟
+// 用法: robotcli [-H 地址] [-p 端口] [-n 指令数] [-r 每秒指令数，0为不限速] [-w 在途上限] [--pose] [--stat]
+
+// 运行状态
+struct SoakState {
+    qint64 count = 0;         // 要发送的指令数
+    qint64 rate = 0;
+    int window = 256;
+    bool pose = false;
+    bool stat = false;
+
+    qint64 sent = 0;
+    qint64 replied = 0;
+    qint64 rejected = 0;
+    qint64 failed = 0;
+    qint64 rttSumUs = 0;
+    qint64 rttMaxUs = 0;
+    qint64 lastReported = 0;
+    quint64 statId = 0;
+    bool running = false;
+    QElapsedTimer clock;
+};
+
+// 第i条指令的角度：各轴在90度附近来回摆动，保持在默认限位和禁区之外
+static int sweepAngle(qint64 i) {
+    return 70 + static_cast<int>((i / RobotProtocol::AXIS_COUNT) % 40);
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("机械臂中转程序压测工具");
+    parser.addHelpOption();
+    parser.addOption({ { "H", "host" }, "中转程序地址", "host", "127.0.0.1" });
+    parser.addOption({ { "p", "port" }, "中转程序端口", "port", "6657" });
+    parser.addOption({ { "n", "count" }, "发送的指令数", "count", "10000" });
+    parser.addOption({ { "r", "rate" }, "每秒指令数，0为不限速", "rate", "0" });
+    parser.addOption({ { "w", "window" }, "在途指令上限", "window", "256" });
+    parser.addOption({ "pose", "每次发送6个轴的完整姿态" });
+    parser.addOption({ "stat", "结束后查询中转程序的队列和限位统计" });
+    parser.process(app);
+
+    SoakState state;
+    state.count = parser.value("count").toLongLong();
+    state.rate = parser.value("rate").toLongLong();
+    state.window = qMax(1, parser.value("window").toInt());
+    state.pose = parser.isSet("pose");
+    state.stat = parser.isSet("stat");
+
+    RobotClient client;
+    client.setMaxOutstanding(state.window);
+    QTimer sendTimer;
+    QTimer reportTimer;
+    sendTimer.setInterval(1);
+    reportTimer.setInterval(1000);
+
+    auto printSummary = [&]() {
+        double seconds = state.clock.nsecsElapsed() / 1e9;
+        out << QString("共发送 %1 条，回复 %2 条，拒绝 %3 条，失败 %4 条，用时 %5 s，%6 条/秒，平均延迟 %7 us，最大延迟 %8 us")
+               .arg(state.sent).arg(state.replied).arg(state.rejected).arg(state.failed)
+               .arg(seconds, 0, 'f', 3).arg(seconds > 0 ? state.replied / seconds : 0.0, 0, 'f', 0)
+               .arg(state.replied ? state.rttSumUs / state.replied : 0).arg(state.rttMaxUs) << endl;
+    };
+
+    // 全部指令都有了结果后结束
+    auto checkDone = [&]() {
+        if (!state.running || state.sent < state.count || state.replied + state.failed < state.sent) {
+            return;
+        }
+        state.running = false;
+        sendTimer.stop();
+        reportTimer.stop();
+        printSummary();
+        if (state.stat) {
+            state.statId = client.stat();
+        }
+        if (state.statId == 0) {
+            app.exit(state.failed ? 1 : 0);
+        }
+    };
+
+    // 按速率补发指令；在途和排队的指令超过两倍窗口时等待回复
+    QObject::connect(&sendTimer, &QTimer::timeout, &app, [&]() {
+        qint64 target = state.count;
+        if (state.rate > 0) {
+            target = qMin(target, state.rate * state.clock.nsecsElapsed() / 1000000000);
+        }
+        while (state.sent < target && client.outstanding() < state.window * 2) {
+            quint64 id;
+            if (state.pose) {
+                QVector<int> angles;
+                for (int axis = 0; axis < RobotProtocol::AXIS_COUNT; ++axis) {
+                    angles.append(sweepAngle(state.sent + axis));
+                }
+                id = client.setPose(angles);
+            } else {
+                id = client.setJoint(static_cast<int>(state.sent % RobotProtocol::AXIS_COUNT), sweepAngle(state.sent));
+            }
+            if (id == 0) {
+                break;                // 连接断开，等重连后继续
+            }
+            state.sent += state.pose ? RobotProtocol::AXIS_COUNT : 1;
+        }
+        if (state.sent >= state.count) {
+            sendTimer.stop();
+        }
+    });
+
+    QObject::connect(&reportTimer, &QTimer::timeout, &app, [&]() {
+        out << QString("已发送 %1，已回复 %2（+%3/s），拒绝 %4，失败 %5，在途 %6")
+               .arg(state.sent).arg(state.replied).arg(state.replied - state.lastReported)
+               .arg(state.rejected).arg(state.failed).arg(client.outstanding()) << endl;
+        state.lastReported = state.replied;
+    });
+
+    // RobotClient的信号在 I/O 线程中发出，以app为接收对象，槽排队到主线程执行，才能操作定时器和state
+    QObject::connect(&client, &RobotClient::replyReceived, &app, [&](quint64 id, bool accepted, const QString &reply, qint64 rttUs) {
+        if (id != 0 && id == state.statId) {
+            out << reply << endl;
+            app.exit(state.failed ? 1 : 0);
+            return;
+        }
+        state.replied++;
+        state.rttSumUs += rttUs;
+        state.rttMaxUs = qMax(state.rttMaxUs, rttUs);
+        if (!accepted) {
+            state.rejected++;
+        }
+        checkDone();
+    });
+
+    QObject::connect(&client, &RobotClient::requestFailed, &app, [&](quint64 id, const QString &) {
+        if (id != 0 && id == state.statId) {
+            app.exit(1);
+            return;
+        }
+        state.failed++;
+        checkDone();
+    });
+
+    QObject::connect(&client, &RobotClient::connected, &app, [&]() {
+        out << "已连接到中转程序" << endl;
+        if (!state.clock.isValid()) {
+            state.clock.start();
+            state.running = true;
+            reportTimer.start();
+        }
+        if (state.running && state.sent < state.count) {
+            sendTimer.start();
+        }
+        checkDone();
+    });
+
+    QObject::connect(&client, &RobotClient::disconnected, &app, [&]() {
+        out << "连接已断开，等待重连..." << endl;
+        sendTimer.stop();
+    });
+
+    QObject::connect(&client, &RobotClient::errorOccurred, &app, [&](const QString &message) {
+        out << "连接错误：" << message << endl;
+    });
+
+    client.connectToHost(parser.value("host"), parser.value("port").toUShort());
+    return app.exec();
+}
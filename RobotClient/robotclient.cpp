@@ -0,0 +1,245 @@
+#include "robotclient.h"
+
+#include <QMutexLocker>
+
+// 默认在途指令上限：足够让滑块和回放连续发送，又不会让中转程序的回复积压太多
+static const int DEFAULT_MAX_OUTSTANDING = 256;
+// 重连间隔：从 RECONNECT_MIN_MS 开始逐次翻倍，最长 RECONNECT_MAX_MS
+static const int RECONNECT_MIN_MS = 500;
+static const int RECONNECT_MAX_MS = 5000;
+
+RobotClient::RobotClient(QObject *parent)
+    : QObject(parent), io(new QObject), socket(new QTcpSocket(io)), reconnectTimer(new QTimer(io)),
+      flushScheduled(false), nextId(1), maxOutstanding(DEFAULT_MAX_OUTSTANDING), autoReconnect(false),
+      port(0), reconnectDelayMs(RECONNECT_MIN_MS), connectedFlag(0), pendingCount(0) {
+    clock.start();
+    reconnectTimer->setSingleShot(true);
+
+    // socket和定时器的事件都在 I/O 线程中处理，界面线程繁忙时不会拖慢收发
+    connect(socket, &QTcpSocket::connected, io, [this]() { onSocketConnected(); });
+    connect(socket, &QTcpSocket::disconnected, io, [this]() { onSocketDisconnected(); });
+    connect(socket, &QTcpSocket::readyRead, io, [this]() { onReadyRead(); });
+    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::error), io, [this]() { onSocketError(); });
+    connect(reconnectTimer, &QTimer::timeout, io, [this]() {
+        if (socket->state() == QAbstractSocket::UnconnectedState) {
+            socket->connectToHost(host, port);
+        }
+    });
+
+    io->moveToThread(&ioThread);
+    ioThread.start();
+}
+
+RobotClient::~RobotClient() {
+    {
+        QMutexLocker locker(&mutex);
+        autoReconnect = false;
+    }
+    QMetaObject::invokeMethod(io, [this]() {
+        reconnectTimer->stop();
+        socket->abort();
+    }, Qt::BlockingQueuedConnection);
+    ioThread.quit();
+    ioThread.wait();
+    delete io;
+}
+
+void RobotClient::connectToHost(const QString &host, quint16 port) {
+    {
+        QMutexLocker locker(&mutex);
+        autoReconnect = true;
+    }
+    QMetaObject::invokeMethod(io, [this, host, port]() {
+        this->host = host;
+        this->port = port;
+        reconnectDelayMs = RECONNECT_MIN_MS;
+        socket->abort();
+        reconnectTimer->stop();
+        socket->connectToHost(host, port);
+    }, Qt::QueuedConnection);
+}
+
+void RobotClient::disconnectFromHost() {
+    {
+        QMutexLocker locker(&mutex);
+        autoReconnect = false;
+    }
+    QMetaObject::invokeMethod(io, [this]() {
+        reconnectTimer->stop();
+        socket->disconnectFromHost();
+    }, Qt::QueuedConnection);
+}
+
+bool RobotClient::isConnected() const {
+    return connectedFlag.loadAcquire() != 0;
+}
+
+quint64 RobotClient::setJoint(int axis, int angle) {
+    return submit({ RobotProtocol::encodeJoint(axis, angle) });
+}
+
+quint64 RobotClient::setPose(const QVector<int> &angles) {
+    QVector<QByteArray> commands;
+    for (int axis = 0; axis < angles.size() && axis < RobotProtocol::AXIS_COUNT; ++axis) {
+        commands.append(RobotProtocol::encodeJoint(axis, angles[axis]));
+    }
+    return submit(commands);
+}
+
+quint64 RobotClient::runMacro(RobotProtocol::Macro macro) {
+    return submit({ RobotProtocol::encodeMacro(macro) });
+}
+
+quint64 RobotClient::test() {
+    return submit({ RobotProtocol::encodeTest() });
+}
+
+quint64 RobotClient::stat() {
+    return submit({ RobotProtocol::encodeStat() });
+}
+
+quint64 RobotClient::quit() {
+    quint64 id = submit({ RobotProtocol::encodeQuit() });
+    if (id != 0) {
+        QMutexLocker locker(&mutex);
+        autoReconnect = false;
+    }
+    return id;
+}
+
+void RobotClient::setMaxOutstanding(int count) {
+    QMutexLocker locker(&mutex);
+    maxOutstanding = qMax(1, count);
+}
+
+int RobotClient::outstanding() const {
+    return pendingCount.loadAcquire();
+}
+
+// 提交一组指令：放入队列，同一时间只安排一次 I/O 线程的写出，之前提交的指令会一起写出
+quint64 RobotClient::submit(const QVector<QByteArray> &commands) {
+    if (commands.isEmpty() || !isConnected()) {
+        return 0;
+    }
+
+    bool schedule = false;
+    quint64 lastId;
+    {
+        QMutexLocker locker(&mutex);
+        for (const QByteArray &command : commands) {
+            queued.enqueue({ nextId++, command, 0 });
+        }
+        lastId = nextId - 1;
+        pendingCount.fetchAndAddRelease(commands.size());
+        if (!flushScheduled) {
+            flushScheduled = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        QMetaObject::invokeMethod(io, [this]() { flush(); }, Qt::QueuedConnection);
+    }
+    return lastId;
+}
+
+// 把排队的指令在在途上限内合并成一次写入
+void RobotClient::flush() {
+    QByteArray batch;
+    qint64 now = clock.nsecsElapsed();
+    {
+        QMutexLocker locker(&mutex);
+        flushScheduled = false;
+        if (socket->state() != QAbstractSocket::ConnectedState) {
+            return;
+        }
+        while (!queued.isEmpty() && inflight.size() < maxOutstanding) {
+            Request request = queued.dequeue();
+            request.sentNs = now;
+            batch.append(request.command);
+            inflight.enqueue(request);
+        }
+    }
+    if (!batch.isEmpty()) {
+        socket->write(batch);
+    }
+}
+
+// 读取回复：按行拆分，依次对应最早的在途指令
+void RobotClient::onReadyRead() {
+    readBuffer.append(socket->readAll());
+    qint64 now = clock.nsecsElapsed();
+    int start = 0;
+    int end;
+    while ((end = readBuffer.indexOf('\n', start)) != -1) {
+        QString reply = QString::fromUtf8(readBuffer.constData() + start, end - start);
+        start = end + 1;
+        if (inflight.isEmpty()) {
+            emit replyReceived(0, RobotProtocol::isAccepted(reply), reply, 0);  // 没有对应请求的回复
+            continue;
+        }
+        Request request = inflight.dequeue();
+        pendingCount.fetchAndSubRelease(1);
+        emit replyReceived(request.id, RobotProtocol::isAccepted(reply), reply, (now - request.sentNs) / 1000);
+    }
+    readBuffer.remove(0, start);
+
+    // 在途指令减少后继续写出排队的指令
+    QMutexLocker locker(&mutex);
+    bool more = !queued.isEmpty();
+    locker.unlock();
+    if (more) {
+        flush();
+    }
+}
+
+void RobotClient::onSocketConnected() {
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);  // 已经在本地合并写入，不需要Nagle
+    reconnectDelayMs = RECONNECT_MIN_MS;
+    failAll("连接已断开");  // 断开瞬间提交的指令已经过时，不在新连接上发送
+    connectedFlag.storeRelease(1);
+    emit connected();
+}
+
+void RobotClient::onSocketDisconnected() {
+    connectedFlag.storeRelease(0);
+    failAll("连接已断开");
+    emit disconnected();
+    scheduleReconnect();
+}
+
+void RobotClient::onSocketError() {
+    if (socket->error() == QAbstractSocket::RemoteHostClosedError) {
+        return;               // 正常断开，由 disconnected 处理
+    }
+    emit errorOccurred(socket->errorString());
+    if (socket->state() == QAbstractSocket::UnconnectedState) {
+        scheduleReconnect();  // 连接失败时不会收到 disconnected
+    }
+}
+
+// 断开时丢弃所有未完成的指令：机械臂指令过时后不应在重连时补发
+void RobotClient::failAll(const QString &reason) {
+    QQueue<Request> failed;
+    {
+        QMutexLocker locker(&mutex);
+        failed.swap(inflight);
+        while (!queued.isEmpty()) {
+            failed.enqueue(queued.dequeue());
+        }
+    }
+    readBuffer.clear();
+    pendingCount.fetchAndSubRelease(failed.size());
+    for (const Request &request : failed) {
+        emit requestFailed(request.id, reason);
+    }
+}
+
+void RobotClient::scheduleReconnect() {
+    QMutexLocker locker(&mutex);
+    if (!autoReconnect || reconnectTimer->isActive()) {
+        return;
+    }
+    locker.unlock();
+    reconnectTimer->start(reconnectDelayMs);
+    reconnectDelayMs = qMin(reconnectDelayMs * 2, RECONNECT_MAX_MS);
+}
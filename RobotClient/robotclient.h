@@ -0,0 +1,98 @@
+#ifndef ROBOTCLIENT_H
+#define ROBOTCLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QQueue>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTcpSocket>
+
+#include "robotprotocol.h"
+
+// 中转程序客户端：只依赖 QtCore 和 QtNetwork，界面、脚本和命令行工具共用
+// - 所有指令接口都可以在任意线程调用，立即返回请求编号，不等待回复
+// - 同一连接上可以有多条在途指令，中转程序逐行回复，按顺序与请求对应
+// - 连续提交的小指令在 I/O 线程中合并成一次写入
+// - 连接意外断开后自动重连；断开时未收到回复的指令通过 requestFailed 通知，不会在重连后补发
+// - 信号在 I/O 线程中发出：连接时要传入接收对象，槽才会排队到接收对象所在的线程执行
+class RobotClient : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RobotClient(QObject *parent = nullptr);
+    ~RobotClient() override;
+
+    // 连接管理
+    void connectToHost(const QString &host, quint16 port);
+    void disconnectFromHost();               // 主动断开，不再重连
+    bool isConnected() const;
+
+    // 异步指令：返回请求编号，回复通过 replyReceived 送达；未连接时返回0
+    quint64 setJoint(int axis, int angle);
+    quint64 setPose(const QVector<int> &angles);      // 6个轴一次写出，返回最后一个轴的请求编号
+    quint64 runMacro(RobotProtocol::Macro macro);
+    quint64 test();
+    quint64 stat();
+    quint64 quit();                                   // 中转程序回复后退出，不再重连
+
+    void setMaxOutstanding(int count);       // 在途指令上限，超出的指令在本地排队
+    int outstanding() const;                 // 已提交但还没收到回复的指令数
+
+signals:
+    void connected();
+    void disconnected();
+    void errorOccurred(const QString &message);
+    void replyReceived(quint64 id, bool accepted, const QString &reply, qint64 rttUs);
+    void requestFailed(quint64 id, const QString &reason);
+
+private:
+    // 一条等待回复的指令
+    struct Request {
+        quint64 id;
+        QByteArray command;
+        qint64 sentNs;        // 写出时间，用于统计往返延迟
+    };
+
+    quint64 submit(const QVector<QByteArray> &commands);
+
+    // 以下函数只在 I/O 线程中执行
+    void flush();
+    void onReadyRead();
+    void onSocketConnected();
+    void onSocketDisconnected();
+    void onSocketError();
+    void failAll(const QString &reason);
+    void scheduleReconnect();
+
+    QThread ioThread;
+    QObject *io;                             // 属于 I/O 线程的上下文对象，socket和定时器都挂在它下面
+    QTcpSocket *socket;
+    QTimer *reconnectTimer;
+    QElapsedTimer clock;
+
+    // 提交队列，由 mutex 保护
+    mutable QMutex mutex;
+    QQueue<Request> queued;                  // 已提交、还没写出的指令
+    bool flushScheduled;
+    quint64 nextId;
+    int maxOutstanding;
+    bool autoReconnect;
+
+    // 只在 I/O 线程中访问
+    QQueue<Request> inflight;                // 已写出、等待回复的指令
+    QByteArray readBuffer;
+    QString host;
+    quint16 port;
+    int reconnectDelayMs;
+
+    QAtomicInt connectedFlag;
+    QAtomicInt pendingCount;
+};
+
+#endif // ROBOTCLIENT_H
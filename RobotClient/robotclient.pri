@@ -0,0 +1,15 @@
+# 中转程序客户端库：只依赖 QtCore 和 QtNetwork
+# 在 .pro 中 include(../RobotClient/robotclient.pri) 即可使用
+
+QT += core network
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += \
+    $$PWD/robotclient.cpp \
+    $$PWD/robotprotocol.cpp
+
+HEADERS += \
+    $$PWD/robotclient.h \
+    $$PWD/robotprotocol.h
@@ -0,0 +1,38 @@
+#include "robotprotocol.h"
+
+namespace RobotProtocol {
+
+QByteArray encodeJoint(int axis, int angle) {
+    QByteArray command;
+    command.append(static_cast<char>(0xAA)); // 包头
+    command.append(static_cast<char>(axis)); // 轴编号
+    command.append(static_cast<char>(angle & 0xFF)); // 角度数据
+    return command;
+}
+
+QByteArray encodeMacro(Macro macro) {
+    QByteArray command;
+    command.append(static_cast<char>(0xBB)); // BB包头
+    command.append(static_cast<char>(macro));
+    return command;
+}
+
+QByteArray encodeTest() {
+    return QByteArray("TEST");
+}
+
+QByteArray encodeStat() {
+    return QByteArray("STAT");
+}
+
+QByteArray encodeQuit() {
+    return QByteArray("quit");
+}
+
+bool isAccepted(const QString &reply) {
+    return !reply.contains(QStringLiteral("拒绝")) && !reply.contains(QStringLiteral("丢弃")) &&
+           !reply.startsWith(QStringLiteral("无效")) &&
+           !reply.startsWith(QStringLiteral("未知"));
+}
+
+}
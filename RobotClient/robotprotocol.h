@@ -0,0 +1,33 @@
+#ifndef ROBOTPROTOCOL_H
+#define ROBOTPROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+
+// 中转程序的指令编码，与 C-Server/command.c 的解析保持一致
+namespace RobotProtocol {
+
+static const int AXIS_COUNT = 6;
+static const int MAX_ANGLE = 180;
+
+// 0xBB宏动作
+enum Macro {
+    MacroReset = 0x00,    // 全部回到90度
+    MacroDown = 0x01,     // 低头
+    MacroUp = 0x02,       // 抬头
+    MacroScrach = 0x03,   // 抓
+    MacroPush = 0x04,     // 放
+};
+
+QByteArray encodeJoint(int axis, int angle);   // 0xAA 轴 角度
+QByteArray encodeMacro(Macro macro);           // 0xBB 动作
+QByteArray encodeTest();                       // TEST
+QByteArray encodeStat();                       // STAT
+QByteArray encodeQuit();                       // quit（中转程序退出，没有后续回复）
+
+// 回复是否表示指令被执行（被限位拒绝、串口队列满被丢弃、包头无效等返回false）
+bool isAccepted(const QString &reply);
+
+}
+
+#endif // ROBOTPROTOCOL_H